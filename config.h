@@ -22,6 +22,10 @@
 #define TERM_MAX_CAPORDER 30
 /* Initial caporder reported by proxy while waiting for real one */
 #define TERM_INIT_CAPORDER 10
+/* Rows per compressed scrollback block (power of 2) */
+#define SCROLLBACK_BLOCK_ROWS 64
+/* Screens of scrollback kept uncompressed above the screen */
+#define SCROLLBACK_WARM_SCREENS 4
 
 /* Default terminal command */
 #define TERM_COMMAND "bash\x1f""bash\x1f-l"
@@ -36,9 +40,15 @@
 #define SOCKET_PATHLEN 104
 
 /* Server version used in protocol handshake */
-#define SERVER_VERSION 1
+#define SERVER_VERSION 3
+/* First server version accepting compressed raw connections */
+#define SERVER_VERSION_ZLIB 2
+/* First server version answering scrollback searches */
+#define SERVER_VERSION_SEARCH 3
 /* Client version used in protocol handshake */
-#define CLIENT_VERSION 1
+#define CLIENT_VERSION 2
+/* First client version accepting row diffs */
+#define CLIENT_VERSION_ROWDIFF 2
 
 /* Maximum size of control sequence fields (including osc fields) */
 #define SEQUENCE_FIELD_MAX 8388608
@@ -53,6 +63,14 @@
 #define READER_BUFSIZE 212992
 /* Size of buffer for writing to connections */
 #define WRITER_BUFSIZE 65536
+/* Number of slots in the writer's response ring (power of 2) */
+#define WRITER_RING_SIZE 1024
+/* Minimum time between terminal updates sent by a writer in milliseconds */
+#define WRITER_FRAME_MIN 16
+/* Maximum time between terminal updates under backpressure in milliseconds */
+#define WRITER_FRAME_MAX 500
+/* Size of buffer for compressing and decompressing connections */
+#define ZLIB_BUFSIZE 65536
 /* Default starting length for body buffer */
 #define BODY_DEF_LENGTH 65536
 /* Maximum length of bodies read from connections */
@@ -61,6 +79,14 @@
 #define BUFFER_WARN_THRESHOLD 1048576
 /* Maximum size of content that can be fetched without a task */
 #define IMAGE_SIZE_THRESHOLD 524288
+/* Maximum number of rows scanned per scrollback search request */
+#define SEARCH_MAX_ROWS 8192
+/* Maximum number of matches returned per scrollback search request */
+#define SEARCH_MAX_RESULTS 256
+/* Maximum length of a scrollback search pattern in bytes */
+#define SEARCH_MAX_PATTERN 256
+/* Maximum number of rows joined into one logical line when searching */
+#define SEARCH_MAX_CONTINUATION 64
 /* Maximum size of key-value attribute lines */
 #define ATTRIBUTE_MAX_LENGTH 4096
 /* Maximum size of uncompressed avatar images (plus 1) */
@@ -72,12 +98,16 @@
 #define IDLE_LAST_TIMEOUT 8000
 /* Time (non-idle) before ratelimiting starts in deciseconds */
 #define RATELIMIT_THRESHOLD 20
-/* Time between ratelimited updates in deciseconds */
-#define RATELIMIT_INTERVAL 5
 /* Default minimum autoclose run time in milliseconds */
 #define DEFAULT_AUTOCLOSE_TIME 1000
 /* Timeout for file tasks */
 #define FILETASK_IDLE_TIME 60000
+/* Upper bound for adaptive task send windows in bytes */
+#define TASK_WINDOW_MAX 16777216
+/* Queued chunks below which task send windows grow */
+#define TASK_WINDOW_ALPHA 2
+/* Queued chunks above which task send windows shrink */
+#define TASK_WINDOW_BETA 4
 /* Timeout for process task (after sending signal) */
 #define RUNTASK_IDLE_TIME 5000
 /* Timeout for attribute scripts and monitor --initial */
@@ -86,6 +116,8 @@
 #define ATTRIBUTE_SCRIPT_WARN    2000
 /* Timeout for querying emulator attributes using osc sequence */
 #define OSC_QUERY_TIMEOUT 1000
+/* Minimum interval between compression statistics updates */
+#define COMPRESS_STATS_INTERVAL 10000
 /* Default keepalive time (update: connect.1) */
 #define KEEPALIVE_DEFAULT 25000
 /* Minimum keepalive time (update: connect.1) */
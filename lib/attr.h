@@ -35,6 +35,8 @@
 #define TSQ_ATTR_AVATAR                 "_avatar"
 #define TSQ_ATTR_LOADAVG                "loadavg"
 
+#define TSQ_ATTR_COMPRESS_PREFIX        "compress."
+
 #define TSQ_ATTR_SERVER_PREFIX          "server."
 #define TSQ_ATTR_SERVER_USER            "server.user"
 #define TSQ_ATTR_SERVER_NAME            "server.name"
@@ -113,6 +115,7 @@
 #define TSQ_ATTR_PREF_MODTIME           "owner-pref.modtime"
 #define TSQ_ATTR_PREF_JOB               "owner-pref.job"
 #define TSQ_ATTR_PREF_INPUT             "owner-pref.input"
+#define TSQ_ATTR_PREF_FILEPAGE          "owner-pref.filepage"
 
 #define TSQ_ATTR_SESSION_PREFIX         "session."
 #define TSQ_ATTR_SESSION_PALETTE        "session.palette"
@@ -167,6 +170,9 @@
 
 #define TSQ_ATTR_FILE_ERROR             "error"
 #define TSQ_ATTR_FILE_OVERLIMIT         "overlimit"
+#define TSQ_ATTR_FILE_OFFSET            "offset"
+#define TSQ_ATTR_FILE_TOTAL             "total"
+#define TSQ_ATTR_FILE_LIMIT             "limit"
 #define TSQ_ATTR_FILE_LINK              "link"
 #define TSQ_ATTR_FILE_LINKMODE          "linkmode"
 #define TSQ_ATTR_FILE_ORPHAN            "orphan"
@@ -71,6 +71,7 @@ const std::string Tsq::attr_PREF_ENVIRON(TSQ_ATTR_PREF_ENVIRON);
 const std::string Tsq::attr_PREF_LANG(TSQ_ATTR_PREF_LANG);
 const std::string Tsq::attr_PREF_MESSAGE(TSQ_ATTR_PREF_MESSAGE);
 const std::string Tsq::attr_PREF_INPUT(TSQ_ATTR_PREF_INPUT);
+const std::string Tsq::attr_PREF_FILEPAGE(TSQ_ATTR_PREF_FILEPAGE);
 
 const std::string Tsq::attr_SESSION_PALETTE(TSQ_ATTR_SESSION_PALETTE);
 const std::string Tsq::attr_SESSION_BADGE(TSQ_ATTR_SESSION_BADGE);
@@ -110,6 +111,9 @@ const std::string Tsq::attr_CONTENT_INLINE(TSQ_ATTR_CONTENT_INLINE);
 
 const std::string Tsq::attr_FILE_ERROR(TSQ_ATTR_FILE_ERROR);
 const std::string Tsq::attr_FILE_OVERLIMIT(TSQ_ATTR_FILE_OVERLIMIT);
+const std::string Tsq::attr_FILE_OFFSET(TSQ_ATTR_FILE_OFFSET);
+const std::string Tsq::attr_FILE_TOTAL(TSQ_ATTR_FILE_TOTAL);
+const std::string Tsq::attr_FILE_LIMIT(TSQ_ATTR_FILE_LIMIT);
 const std::string Tsq::attr_FILE_LINK(TSQ_ATTR_FILE_LINK);
 const std::string Tsq::attr_FILE_LINKMODE(TSQ_ATTR_FILE_LINKMODE);
 const std::string Tsq::attr_FILE_ORPHAN(TSQ_ATTR_FILE_ORPHAN);
@@ -71,6 +71,7 @@ namespace Tsq {
     extern const std::string attr_PREF_LANG;
     extern const std::string attr_PREF_MESSAGE;
     extern const std::string attr_PREF_INPUT;
+    extern const std::string attr_PREF_FILEPAGE;
 
     extern const std::string attr_SESSION_PALETTE;
     extern const std::string attr_SESSION_BADGE;
@@ -110,6 +111,9 @@ namespace Tsq {
 
     extern const std::string attr_FILE_ERROR;
     extern const std::string attr_FILE_OVERLIMIT;
+    extern const std::string attr_FILE_OFFSET;
+    extern const std::string attr_FILE_TOTAL;
+    extern const std::string attr_FILE_LIMIT;
     extern const std::string attr_FILE_LINK;
     extern const std::string attr_FILE_LINKMODE;
     extern const std::string attr_FILE_ORPHAN;
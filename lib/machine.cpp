@@ -6,6 +6,8 @@
 #include "machine.h"
 #include "exception.h"
 
+#include <sys/uio.h>
+
 namespace Tsq
 {
     ProtocolMachine::ProtocolMachine(ProtocolCallback *parent, const char *buf, size_t len) :
@@ -64,6 +66,19 @@ namespace Tsq
         return std::string(buf, len);
     }
 
+    const ProtocolStats *
+    ProtocolMachine::stats() const
+    {
+        return nullptr;
+    }
+
+    void
+    ProtocolCallback::writevFd(struct iovec *iov, int iovcnt)
+    {
+        for (int i = 0; i < iovcnt; ++i)
+            writeFd((const char *)iov[i].iov_base, iov[i].iov_len);
+    }
+
     void
     ProtocolCallback::eofCallback(int errnum)
     {
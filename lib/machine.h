@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <atomic>
+
+struct iovec;
+
 namespace Tsq
 {
     class ProtocolCallback
@@ -11,10 +15,22 @@ namespace Tsq
     public:
         virtual bool protocolCallback(uint32_t command, uint32_t length, const char *body) = 0;
         virtual void writeFd(const char *buf, size_t len) = 0;
+        // Gathered write, by default one writeFd per buffer
+        // The vector may be advanced in place as it is written
+        virtual void writevFd(struct iovec *iov, int iovcnt);
 
         virtual void eofCallback(int errnum);
     };
 
+    // Input is counted by the reading thread, output by the writing thread
+    struct ProtocolStats
+    {
+        std::atomic_uint_fast64_t rawIn{0}, wireIn{0};
+        std::atomic_uint_fast64_t rawOut{0}, wireOut{0};
+        // Thread CPU time spent in the codec, in nanoseconds
+        std::atomic_uint_fast64_t inflateTime{0}, deflateTime{0};
+    };
+
     class ProtocolMachine
     {
     protected:
@@ -36,6 +52,7 @@ namespace Tsq
         virtual void connFlush(const char *buf, size_t len);
 
         virtual std::string encode(const char *buf, size_t len);
+        virtual const ProtocolStats* stats() const;
 
         virtual bool start();
         virtual void reset();
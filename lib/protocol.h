@@ -17,6 +17,7 @@
 #define TSQ_PROTOCOL_RAW_SERVER        5
 #define TSQ_PROTOCOL_TERM_SERVERFD     6
 #define TSQ_PROTOCOL_RAW_SERVERFD      7
+#define TSQ_PROTOCOL_RAW_ZLIB          8
 
 /*
  * Disconnect/exit codes
@@ -35,6 +36,13 @@
 #define TSQ_STATUS_IDLE_TIMEOUT        11
 #define TSQ_FLAG_PROXY_CLOSED          0x80000000
 
+/*
+ * Scrollback search flags
+ */
+#define TSQ_SEARCH_REGEX               1
+#define TSQ_SEARCH_ICASE               2
+#define TSQ_SEARCH_REVERSE             4
+
 /*
  * Command type mask and codes
  */
@@ -78,6 +86,9 @@
 // IN data
 #define TSQ_DISCARD                                        _P(9)
 
+// IN data | OUT data (segment of the connection's deflate stream)
+#define TSQ_COMPRESSED                                     _P(10)
+
 /*
  * Server commands
  */
@@ -269,6 +280,14 @@
 // OUTPUT Starting: mode size8 Running:(data|empty) Error:code errstr
 #define TSQ_DOWNLOAD_IMAGE                                 _T(3016)
 
+// OUT termid rownum8 flags+bufid modtime basecrc nranges rstart rremove sstart sremove range... string
+#define TSQ_ROW_DIFF                                       _T(3017)
+
+// IN termid clientid bufid+flags start8 count8 limit pattern
+// RESP clientid termid bufid next8 (row8 startpos endpos)...
+#define TSQ_SEARCH_ROWS                                    _T(3018)
+#define TSQ_SEARCH_ROWS_RESPONSE                           _C(3018)
+
 /*
  * Terminal management and metadata
  */
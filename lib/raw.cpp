@@ -9,6 +9,7 @@
 #include "exception.h"
 
 #include <unistd.h>
+#include <sys/uio.h>
 
 // can't exceed BODY_DEF_LENGTH
 #define HEADER_SIZE 8
@@ -161,37 +162,33 @@ namespace Tsq
     void
     RawProtocol::connSend(const char *buf, size_t len)
     {
-        size_t room;
-        unsigned padoff = len & 3;
-
-    restart:
-        while (1) {
-            room = m_outsize - m_outpos;
+        /* pad length out to 4 bytes */
+        size_t padlen = (4 - (len & 3)) & 3;
 
-            if (room == 0) {
-                m_parent->writeFd(m_outbuf, m_outsize);
-                m_outpos = 0;
-            }
-            else if (room >= len) {
-                memcpy(m_outbuf + m_outpos, buf, len);
-                m_outpos += len;
-                break;
-            }
-            else {
-                memcpy(m_outbuf + m_outpos, buf, room);
-                m_outpos += room;
-                buf += room;
-                len -= room;
-            }
+        if (m_outsize - m_outpos >= len + padlen) {
+            memcpy(m_outbuf + m_outpos, buf, len);
+            memcpy(m_outbuf + m_outpos + len, padding, padlen);
+            m_outpos += len + padlen;
+            return;
         }
 
-        /* pad length out to 4 bytes */
-        if (padoff) {
-            buf = padding;
-            len = 4 - padoff;
-            padoff = 0;
-            goto restart;
+        // Send the staged data and the body in one gathered write instead
+        // of copying the body through the buffer
+        struct iovec iov[3];
+        int n = 0;
+
+        if (m_outpos) {
+            iov[n].iov_base = m_outbuf;
+            iov[n++].iov_len = m_outpos;
+            m_outpos = 0;
+        }
+        iov[n].iov_base = const_cast<char *>(buf);
+        iov[n++].iov_len = len;
+        if (padlen) {
+            iov[n].iov_base = const_cast<char *>(padding);
+            iov[n++].iov_len = padlen;
         }
+        m_parent->writevFd(iov, n);
     }
 
     void
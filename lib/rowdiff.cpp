@@ -0,0 +1,85 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "rowdiff.h"
+#include "endian.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+namespace Tsq
+{
+    void
+    diffRows(const std::vector<uint32_t> &pr, const std::string &ps,
+             const std::vector<uint32_t> &r, const std::string &s,
+             RowDiff &diff)
+    {
+        // Common prefix and suffix of the ranges, in whole ranges
+        size_t rlimit = std::min(pr.size(), r.size());
+        size_t rstart = 0, rsuffix = 0;
+        while (rstart < rlimit && !memcmp(&pr[rstart], &r[rstart], 24))
+            rstart += 6;
+        while (rstart + rsuffix < rlimit &&
+               !memcmp(&pr[pr.size() - rsuffix - 6], &r[r.size() - rsuffix - 6], 24))
+            rsuffix += 6;
+
+        // Common prefix and suffix of the string, in bytes
+        size_t slimit = std::min(ps.size(), s.size());
+        size_t sstart = 0, ssuffix = 0;
+        while (sstart < slimit && ps[sstart] == s[sstart])
+            ++sstart;
+        while (sstart + ssuffix < slimit &&
+               ps[ps.size() - ssuffix - 1] == s[s.size() - ssuffix - 1])
+            ++ssuffix;
+
+        diff.rstart = rstart / 6;
+        diff.rremove = (pr.size() - rstart - rsuffix) / 6;
+        diff.radd = (r.size() - rstart - rsuffix) / 6;
+        diff.sstart = sstart;
+        diff.sremove = ps.size() - sstart - ssuffix;
+        diff.sadd = s.size() - sstart - ssuffix;
+    }
+
+    uint32_t
+    rowChecksum(const std::vector<uint32_t> &ranges, const std::string &str)
+    {
+        uLong crc = crc32(0, Z_NULL, 0);
+
+        #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        for (uint32_t word: ranges) {
+            word = htole32(word);
+            crc = crc32(crc, reinterpret_cast<const Bytef *>(&word), 4);
+        }
+        #else
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(ranges.data()), ranges.size() * 4);
+        #endif
+
+        return crc32(crc, reinterpret_cast<const Bytef *>(str.data()), str.size());
+    }
+
+    bool
+    patchRow(const std::vector<uint32_t> &ranges, const std::string &str,
+             uint32_t checksum, const RowDiff &diff,
+             const uint32_t *addRanges, const char *addStr,
+             std::vector<uint32_t> &outRanges, std::string &outStr)
+    {
+        // Base must match the version the diff was made against
+        if ((diff.rstart + diff.rremove) * 6 > ranges.size() ||
+            diff.sstart + diff.sremove > str.size() ||
+            rowChecksum(ranges, str) != checksum)
+            return false;
+
+        auto rmid = ranges.begin() + diff.rstart * 6;
+        outRanges.insert(outRanges.end(), ranges.begin(), rmid);
+        outRanges.insert(outRanges.end(), addRanges, addRanges + diff.radd * 6);
+        outRanges.insert(outRanges.end(), rmid + diff.rremove * 6, ranges.end());
+
+        outStr.append(str, 0, diff.sstart);
+        outStr.append(addStr, diff.sadd);
+        outStr.append(str, diff.sstart + diff.sremove, std::string::npos);
+        return true;
+    }
+}
@@ -0,0 +1,41 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Tsq
+{
+    //
+    // Row diffs, as sent in TSQ_ROW_DIFF
+    // Ranges are six words each, in host byte order
+    //
+    struct RowDiff
+    {
+        // Counted in ranges
+        size_t rstart, rremove, radd;
+        // Counted in bytes
+        size_t sstart, sremove, sadd;
+    };
+
+    // Finds the changed span of ranges and text between two versions of a row
+    extern void
+    diffRows(const std::vector<uint32_t> &prevRanges, const std::string &prevStr,
+             const std::vector<uint32_t> &ranges, const std::string &str,
+             RowDiff &diff);
+
+    // CRC-32 of the little endian range words followed by the text
+    extern uint32_t
+    rowChecksum(const std::vector<uint32_t> &ranges, const std::string &str);
+
+    // Appends the patched row to outRanges and outStr. Returns false if the
+    // diff does not fit the base or the base checksum does not match
+    extern bool
+    patchRow(const std::vector<uint32_t> &ranges, const std::string &str,
+             uint32_t checksum, const RowDiff &diff,
+             const uint32_t *addRanges, const char *addStr,
+             std::vector<uint32_t> &outRanges, std::string &outStr);
+}
@@ -0,0 +1,106 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "textmatch.h"
+
+#include <cstring>
+
+static inline char
+foldAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+namespace Tsq
+{
+    bool
+    TextMatcher::setLiteral(const std::string &literal, bool icase)
+    {
+        if (literal.empty())
+            return false;
+
+        m_literal = literal;
+        m_icase = icase;
+
+        if (icase)
+            for (char &c: m_literal) {
+                // Folding non-ASCII text is left to the regex
+                if (c & 0x80) {
+                    m_literal.clear();
+                    return false;
+                }
+                c = foldAscii(c);
+            }
+
+        return true;
+    }
+
+    bool
+    TextMatcher::findLiteral(const std::string &str, size_t pos, size_t &start) const
+    {
+        const size_t n = m_literal.size();
+        if (str.size() < n)
+            return false;
+
+        const char *base = str.data();
+        const char *last = base + str.size() - n + 1;
+        const char first = m_literal[0];
+        const bool alpha = m_icase && first >= 'a' && first <= 'z';
+        const char other = alpha ? first - ('a' - 'A') : first;
+
+        for (const char *p = base + pos; p < last; ++p) {
+            // Skip ahead to a candidate first byte
+            const char *a = (const char *)memchr(p, first, last - p);
+            if (alpha) {
+                const char *b = (const char *)memchr(p, other, (a ? a : last) - p);
+                if (b)
+                    a = b;
+            }
+            if (!a)
+                break;
+
+            p = a;
+            size_t i = 1;
+            if (m_icase)
+                while (i < n && foldAscii(p[i]) == m_literal[i])
+                    ++i;
+            else if (memcmp(p + 1, m_literal.data() + 1, n - 1) == 0)
+                i = n;
+
+            if (i == n) {
+                start = p - base;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool
+    TextMatcher::find(const std::string &str, size_t pos, size_t &start, size_t &end) const
+    {
+        if (pos > str.size())
+            return false;
+
+        if (!m_regex) {
+            if (!findLiteral(str, pos, start))
+                return false;
+
+            end = start + m_literal.size();
+            return true;
+        }
+
+        std::smatch match;
+        auto flags = pos ? std::regex_constants::match_prev_avail :
+            std::regex_constants::match_default;
+
+        if (!std::regex_search(str.cbegin() + pos, str.cend(), match, *m_regex, flags))
+            return false;
+
+        start = pos + match.position();
+        end = start + match.length();
+        return true;
+    }
+}
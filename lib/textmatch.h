@@ -0,0 +1,34 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <regex>
+#include <string>
+
+namespace Tsq
+{
+    //
+    // Literal or regex matcher over joined lines of text
+    // Literals are scanned with memchr, anything else falls back to std::regex
+    //
+    class TextMatcher
+    {
+    private:
+        const std::regex *m_regex = nullptr;
+        std::string m_literal;
+        bool m_icase = false;
+
+        bool findLiteral(const std::string &str, size_t pos, size_t &start) const;
+
+    public:
+        // Returns false if the literal must be matched with a regex instead
+        bool setLiteral(const std::string &literal, bool icase);
+        // The regex must outlive the matcher
+        inline void setRegex(const std::regex *regex) { m_regex = regex; }
+
+        // Byte span of the first match at or after pos
+        bool find(const std::string &str, size_t pos, size_t &start, size_t &end) const;
+    };
+}
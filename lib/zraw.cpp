@@ -0,0 +1,225 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "zraw.h"
+#include "raw.h"
+#include "protocol.h"
+#include "endian.h"
+#include "config.h"
+#include "exception.h"
+
+#include <ctime>
+
+#define HEADER_SIZE 8
+
+namespace Tsq
+{
+    static inline uint64_t
+    cputime()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+
+    inline void
+    ZlibProtocol::init()
+    {
+        memset(&m_deflate, 0, sizeof(m_deflate));
+        memset(&m_inflate, 0, sizeof(m_inflate));
+
+        if (deflateInit(&m_deflate, Z_BEST_SPEED) != Z_OK ||
+            inflateInit(&m_inflate) != Z_OK)
+            throw std::bad_alloc();
+
+        m_framer = new RawProtocol(this);
+        m_submachine = new RawProtocol(this);
+        m_chunk = new char[ZLIB_BUFSIZE];
+        m_outbuf.assign(HEADER_SIZE, '\0');
+        m_inflating = false;
+    }
+
+    ZlibProtocol::ZlibProtocol(ProtocolCallback *parent, const char *buf, size_t len) :
+        ProtocolMachine(parent, buf, len)
+    {
+        init();
+    }
+
+    ZlibProtocol::ZlibProtocol(ProtocolCallback *parent) :
+        ProtocolMachine(parent)
+    {
+        init();
+    }
+
+    ZlibProtocol::~ZlibProtocol()
+    {
+        deflateEnd(&m_deflate);
+        inflateEnd(&m_inflate);
+
+        delete [] m_chunk;
+        delete m_submachine;
+        delete m_framer;
+    }
+
+    void
+    ZlibProtocol::compress(const char *buf, size_t len, int flush)
+    {
+        uint64_t started = cputime();
+
+        m_deflate.next_in = (Bytef *)buf;
+        m_deflate.avail_in = len;
+        m_stats.rawOut += len;
+
+        do {
+            size_t pos = m_outbuf.size();
+            m_outbuf.resize(pos + ZLIB_BUFSIZE);
+            m_deflate.next_out = (Bytef *)&m_outbuf[pos];
+            m_deflate.avail_out = ZLIB_BUFSIZE;
+            deflate(&m_deflate, flush);
+            m_outbuf.resize(pos + ZLIB_BUFSIZE - m_deflate.avail_out);
+        } while (m_deflate.avail_out == 0);
+
+        m_stats.deflateTime += cputime() - started;
+    }
+
+    std::string
+    ZlibProtocol::frame()
+    {
+        std::string result;
+        uint32_t len = m_outbuf.size() - HEADER_SIZE;
+
+        if (len) {
+            uint32_t *hdr = reinterpret_cast<uint32_t *>(&m_outbuf[0]);
+            hdr[0] = htole32(TSQ_COMPRESSED);
+            hdr[1] = htole32(len);
+
+            /* pad length out to 4 bytes */
+            m_outbuf.append((4 - (len & 3)) & 3, '\0');
+            m_stats.wireOut += m_outbuf.size();
+
+            result = m_outbuf;
+            m_outbuf.resize(HEADER_SIZE);
+        }
+        return result;
+    }
+
+    bool
+    ZlibProtocol::decompress(const char *buf, size_t len)
+    {
+        m_inflate.next_in = (Bytef *)buf;
+        m_inflate.avail_in = len;
+        m_inflating = true;
+
+        do {
+            uint64_t started = cputime();
+
+            m_inflate.next_out = (Bytef *)m_chunk;
+            m_inflate.avail_out = ZLIB_BUFSIZE;
+
+            int rc = inflate(&m_inflate, Z_NO_FLUSH);
+            if (rc != Z_OK && rc != Z_BUF_ERROR)
+                throw ProtocolException();
+
+            size_t got = ZLIB_BUFSIZE - m_inflate.avail_out;
+            m_stats.rawIn += got;
+            m_stats.inflateTime += cputime() - started;
+
+            if (got && !m_submachine->connRead(m_chunk, got)) {
+                m_inflating = false;
+                return false;
+            }
+        } while (m_inflate.avail_out == 0);
+
+        m_inflating = false;
+        return true;
+    }
+
+    bool
+    ZlibProtocol::connRead(const char *buf, size_t len)
+    {
+        return m_framer->connRead(buf, len);
+    }
+
+    bool
+    ZlibProtocol::connRead(int fd)
+    {
+        return m_framer->connRead(fd);
+    }
+
+    void
+    ZlibProtocol::connSend(const char *buf, size_t len)
+    {
+        m_submachine->connSend(buf, len);
+    }
+
+    void
+    ZlibProtocol::connFlush(const char *buf, size_t len)
+    {
+        m_submachine->connFlush(buf, len);
+        compress(nullptr, 0, Z_SYNC_FLUSH);
+
+        std::string out = frame();
+        if (!out.empty())
+            m_parent->writeFd(out.data(), out.size());
+    }
+
+    std::string
+    ZlibProtocol::encode(const char *buf, size_t len)
+    {
+        static const char padding[4] = { 0 };
+
+        compress(buf, len, Z_NO_FLUSH);
+        compress(padding, (4 - (len & 3)) & 3, Z_SYNC_FLUSH);
+        return frame();
+    }
+
+    const ProtocolStats *
+    ZlibProtocol::stats() const
+    {
+        return &m_stats;
+    }
+
+    bool
+    ZlibProtocol::protocolCallback(uint32_t command, uint32_t length, const char *body)
+    {
+        // Commands from the inner stream, or sent uncompressed
+        if (command != TSQ_COMPRESSED)
+            return m_parent->protocolCallback(command, length, body);
+        if (m_inflating)
+            throw ProtocolException();
+
+        m_stats.wireIn += HEADER_SIZE + ((length + 3) & ~3);
+        return decompress(body, length);
+    }
+
+    void
+    ZlibProtocol::writeFd(const char *buf, size_t len)
+    {
+        // Framed output from the submachine
+        compress(buf, len, Z_NO_FLUSH);
+
+        if (m_outbuf.size() >= WRITER_BUFSIZE) {
+            std::string out = frame();
+            m_parent->writeFd(out.data(), out.size());
+        }
+    }
+
+    void
+    ZlibProtocol::eofCallback(int errnum)
+    {
+        m_parent->eofCallback(errnum);
+    }
+
+    void
+    ZlibProtocol::reset()
+    {
+        m_framer->reset();
+        m_submachine->reset();
+        deflateReset(&m_deflate);
+        inflateReset(&m_inflate);
+        m_outbuf.assign(HEADER_SIZE, '\0');
+        m_inflating = false;
+    }
+}
@@ -0,0 +1,58 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "machine.h"
+
+#include <zlib.h>
+
+namespace Tsq
+{
+    class ProtocolCallback;
+    class RawProtocol;
+
+    //
+    // Raw protocol carried inside a deflate stream
+    // Each flush emits the compressed bytes as one TSQ_COMPRESSED command,
+    // uncompressed commands may still be interleaved between them
+    //
+    class ZlibProtocol: public ProtocolMachine, public ProtocolCallback
+    {
+    private:
+        RawProtocol *m_framer, *m_submachine;
+
+        z_stream m_deflate, m_inflate;
+        std::string m_outbuf;
+        char *m_chunk;
+        bool m_inflating;
+
+        ProtocolStats m_stats;
+
+        void init();
+        void compress(const char *buf, size_t len, int flush);
+        bool decompress(const char *buf, size_t len);
+        std::string frame();
+
+    public:
+        ZlibProtocol(ProtocolCallback *parent, const char *buf, size_t len);
+        ZlibProtocol(ProtocolCallback *parent);
+        ~ZlibProtocol();
+
+        bool connRead(const char *buf, size_t len);
+        bool connRead(int fd);
+
+        void connSend(const char *buf, size_t len);
+        void connFlush(const char *buf, size_t len);
+
+        std::string encode(const char *buf, size_t len);
+        const ProtocolStats* stats() const;
+
+        bool protocolCallback(uint32_t command, uint32_t length, const char *body);
+        void writeFd(const char *buf, size_t len);
+        void eofCallback(int errnum);
+
+        void reset();
+    };
+}
@@ -49,7 +49,9 @@ ArgParser::handleServerHelp()
 #if USE_LIBGIT2
            "--nogit      Disable git-specific file monitoring support\n"
 #endif
-           "--rundir DIR Use runtime path DIR\n",
+           "--rundir DIR Use runtime path DIR\n"
+           "--spill ROWS Keep at most ROWS of old scrollback in memory per terminal\n"
+           "--pooled     Run terminals and connections on a shared pool of threads\n",
            TR_DESC1);
     puts("--help       Show this help\n"
          "--man        Launch man page\n"
@@ -145,6 +147,14 @@ ArgParser::parseServerArg(char *const *argv, int &pos, int limit)
             throw TsqException("%s", tmp.c_str());
         }
     }
+    else if (!strcmp(arg, "--spill")) {
+        if (pos < limit - 1 && strncmp(argv[pos + 1], "--", 2))
+            m_spill = atoi(argv[++pos]);
+        else {
+            this->arg(tmp, TR_PARSE1, "--spill");
+            throw TsqException("%s", tmp.c_str());
+        }
+    }
 
     else if (!strcmp(arg, "--help"))
         handleServerHelp();
@@ -154,6 +164,8 @@ ArgParser::parseServerArg(char *const *argv, int &pos, int limit)
         m_fdpurge = false;
     else if (!strcmp(arg, "--nogit"))
         m_git = false;
+    else if (!strcmp(arg, "--pooled"))
+        m_pooled = true;
 
     else {
         this->arg(tmp, TR_PARSE2, arg);
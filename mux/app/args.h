@@ -26,6 +26,8 @@ private:
     bool m_activated = false;
     bool m_fdpurge = true;
     bool m_git = true;
+    bool m_pooled = false;
+    unsigned m_spill = 0;
 
     // Connector
     bool m_pty = false;
@@ -70,6 +72,8 @@ public:
     inline bool activated() const { return m_activated; }
     inline bool fdpurge() const { return m_fdpurge; }
     inline bool git() const { return m_git; }
+    inline bool pooled() const { return m_pooled; }
+    inline unsigned spill() const { return m_spill; }
 
     // Connector
     inline bool pty() const { return m_pty; }
@@ -246,6 +246,7 @@ TermForwarder::writeDisconnect()
 
     switch(m_protocolType) {
     case TSQ_PROTOCOL_RAW:
+    case TSQ_PROTOCOL_RAW_ZLIB:
         write(STDOUT_FILENO, TSQ_RAW_DISCONNECT, TSQ_RAW_DISCONNECT_LEN);
         break;
     case TSQ_PROTOCOL_TERM:
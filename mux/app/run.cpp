@@ -6,6 +6,7 @@
 #include "run.h"
 #include "args.h"
 #include "base/listener.h"
+#include "base/eventpool.h"
 #include "base/exception.h"
 #include "os/dir.h"
 #include "os/conn.h"
@@ -40,6 +41,16 @@ loadPlugins()
     osLoadPlugins();
 }
 
+static inline void
+startPool()
+{
+    if (g_args->pooled()) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        g_pool = new EventPool(n > 0 ? n : 1);
+        LOGDBG("Pool: started %u workers\n", g_pool->nthreads());
+    }
+}
+
 static void
 scrubEnvironment()
 {
@@ -57,6 +68,7 @@ runStandalone()
     scrubEnvironment();
 
     try {
+        startPool();
         g_listener = new TermListener(STDIN_FILENO, STDOUT_FILENO, flavor);
         rc = g_listener->run(-1);
         delete g_listener;
@@ -82,6 +94,7 @@ runListener(int initialrd, int initialwd)
         LOGDBG("Translator: Loaded %s\n", g_args->defaultTranslator()->path.c_str());
 
     try {
+        startPool();
         g_listener = new TermListener(initialrd, initialwd, flavor);
         rc = g_listener->run(s_listenfd);
         delete g_listener;
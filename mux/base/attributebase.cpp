@@ -9,8 +9,8 @@
 
 #include <pthread.h>
 
-AttributeBase::AttributeBase(const char *name) :
-    ThreadBase(name, ThreadBaseFd)
+AttributeBase::AttributeBase(const char *name, unsigned flags) :
+    ThreadBase(name, flags)
 {
     if (pthread_rwlock_init(&m_rwlock, NULL) < 0)
         throw ErrnoException("pthread_rwlock_init", errno);
@@ -24,7 +24,7 @@ protected:
     Tsq::Uuid m_id;
 
 public:
-    AttributeBase(const char *name);
+    AttributeBase(const char *name, unsigned flags = ThreadBaseFd);
     ~AttributeBase();
 
     inline const Tsq::Uuid& id() const { return m_id; }
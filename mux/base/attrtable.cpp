@@ -0,0 +1,61 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "attrtable.h"
+
+int
+AttributeTable::intern(const CellAttributes &a)
+{
+    auto i = m_map.find(a);
+    if (i != m_map.end())
+        return i->second;
+
+    uint16_t id;
+
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+        m_entries[id] = a;
+    }
+    else if (m_entries.size() == ATTRTABLE_MAX) {
+        return -1;
+    }
+    else {
+        id = m_entries.size();
+        m_entries.push_back(a);
+    }
+
+    m_map.emplace(a, id);
+    return id;
+}
+
+size_t
+AttributeTable::sweep(const std::vector<bool> &live)
+{
+    size_t freed = 0;
+
+    for (uint16_t id = 0; id < m_entries.size(); ++id) {
+        if (live[id])
+            continue;
+
+        // Entries already on the free list are no longer mapped
+        auto i = m_map.find(m_entries[id]);
+        if (i != m_map.end() && i->second == id) {
+            m_map.erase(i);
+            m_free.push_back(id);
+            ++freed;
+        }
+    }
+
+    return freed;
+}
+
+void
+AttributeTable::clear()
+{
+    m_entries.clear();
+    m_free.clear();
+    m_map.clear();
+}
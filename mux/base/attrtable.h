@@ -0,0 +1,44 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "cell.h"
+
+#include <unordered_map>
+
+#define ATTRTABLE_MAX 0xffff
+
+struct CellAttributesHash
+{
+    inline size_t operator()(const CellAttributes &a) const {
+        size_t h = a.flags;
+        h = h * 0x9e3779b97f4a7c15 + a.fg;
+        h = h * 0x9e3779b97f4a7c15 + a.bg;
+        return h * 0x9e3779b97f4a7c15 + a.link;
+    }
+};
+
+//
+// Per-buffer table of distinct attribute runs, indexed by 16-bit id
+// Used by packed (scrollback) rows in place of full attribute words
+//
+class AttributeTable
+{
+private:
+    std::vector<CellAttributes> m_entries;
+    std::vector<uint16_t> m_free;
+    std::unordered_map<CellAttributes,uint16_t,CellAttributesHash> m_map;
+
+public:
+    inline const CellAttributes& at(uint16_t id) const { return m_entries[id]; }
+    inline size_t size() const { return m_entries.size(); }
+    inline size_t used() const { return m_map.size(); }
+
+    // Returns -1 if the table is full
+    int intern(const CellAttributes &a);
+    // Frees the ids not marked live for reuse, returns the number freed
+    size_t sweep(const std::vector<bool> &live);
+    void clear();
+};
@@ -5,6 +5,10 @@
 #include "common.h"
 #include "buffer.h"
 #include "emulator.h"
+#include "rowsearch.h"
+#include "app/args.h"
+#include "os/logging.h"
+#include "config.h"
 
 #include <unordered_set>
 
@@ -22,11 +26,15 @@ TermBuffer::TermBuffer(TermEmulator *emulator, unsigned screenHeight,
         ++caporder;
 
     m_capacity = 1 << caporder;
-    m_capmask = m_capacity - 1;
     m_caporder = caporder;
 
+    if (g_args->spill())
+        m_cold.setWindow(g_args->spill() / SCROLLBACK_BLOCK_ROWS + 1);
+
     while (screenHeight--)
         m_rows.emplace_back();
+
+    pthread_mutex_init(&m_snapLock, NULL);
 }
 
 TermBuffer::TermBuffer(TermEmulator *emulator, const TermBuffer *copyfrom) :
@@ -34,7 +42,7 @@ TermBuffer::TermBuffer(TermEmulator *emulator, const TermBuffer *copyfrom) :
     m_size(copyfrom->m_size),
     m_realsize(copyfrom->m_realsize),
     m_capacity(copyfrom->m_capacity),
-    m_capmask(copyfrom->m_capmask),
+    m_base(copyfrom->m_base),
     m_modTimePtr(emulator->modTimePtr()),
     m_screenHeight(copyfrom->m_screenHeight),
     m_id(copyfrom->m_id),
@@ -42,6 +50,9 @@ TermBuffer::TermBuffer(TermEmulator *emulator, const TermBuffer *copyfrom) :
     m_noScrollback(copyfrom->m_noScrollback),
     m_nextRegionId(copyfrom->m_nextRegionId),
     m_rows(copyfrom->m_rows),
+    m_attributes(copyfrom->m_attributes),
+    m_packResume(copyfrom->m_packResume),
+    m_cold(copyfrom->m_cold),
     m_regions(copyfrom->m_regions)
 {
     std::map<Region*,Region*> copies;
@@ -56,10 +67,14 @@ TermBuffer::TermBuffer(TermEmulator *emulator, const TermBuffer *copyfrom) :
         m_regionsByStart.emplace(copies[i.ptr]);
     for (const auto &i: copyfrom->m_regionsByEnd)
         m_regionsByEnd.emplace(copies[i.ptr]);
+
+    pthread_mutex_init(&m_snapLock, NULL);
 }
 
 TermBuffer::~TermBuffer()
 {
+    pthread_mutex_destroy(&m_snapLock);
+
     for (const auto &i: m_regions)
         i.second->putReference();
 }
@@ -78,6 +93,195 @@ TermBuffer::deleteRegion(Region *region)
     region->putReference();
 }
 
+void
+TermBuffer::packRows(index_t start, index_t end)
+{
+    // Cold rows are already packed
+    if (start < m_base)
+        start = m_base;
+
+    for (; start < end && m_size >= m_packResume; ++start) {
+        CellRow &row = slot(start);
+        if (!row.isPacked() && !row.pack(m_attributes) && sweepAttributes())
+            row.pack(m_attributes);
+    }
+}
+
+bool
+TermBuffer::sweepAttributes()
+{
+    // Free table entries no longer used by any packed row
+    std::vector<bool> live(m_attributes.size());
+
+    for (const auto &row: m_rows)
+        row.markAttributes(live);
+    m_cold.markAttributes(live);
+
+    size_t freed = m_attributes.sweep(live);
+    if (freed >= ATTRTABLE_MAX / 8)
+        return true;
+
+    // Mostly live: wait for the scrollback to turn over before trying again
+    m_packResume = m_size + m_capacity;
+    LOGNOT("Buffer %p: attribute table full (%zu freed), packing suspended\n",
+           this, freed);
+    return false;
+}
+
+void
+TermBuffer::unpackRows()
+{
+    for (auto &row: m_rows)
+        if (row.isPacked())
+            row.unpack(m_attributes);
+}
+
+index_t
+TermBuffer::coldLimit() const
+{
+    // Rows further above the screen are compressed
+    index_t warm = (SCROLLBACK_WARM_SCREENS + 1) * m_screenHeight;
+    return m_size > warm ? m_size - warm : 0;
+}
+
+void
+TermBuffer::freezeRows()
+{
+    index_t limit = coldLimit();
+    index_t low = lower();
+
+    m_cold.dropBelow(low);
+
+    if (m_cold.empty()) {
+        // Rows falling out of the scrollback
+        for (; m_base < low; ++m_base)
+            m_rows.pop_front();
+
+        if (m_cold.end() != m_base)
+            m_cold.reset(m_base);
+    }
+
+    while (m_base + SCROLLBACK_BLOCK_ROWS <= limit) {
+        auto i = m_rows.begin(), j = i + SCROLLBACK_BLOCK_ROWS;
+        std::vector<CellRow> rows(std::make_move_iterator(i), std::make_move_iterator(j));
+
+        m_rows.erase(i, j);
+        m_base += SCROLLBACK_BLOCK_ROWS;
+        m_cold.push(rows);
+    }
+}
+
+void
+TermBuffer::thawRows(index_t limit)
+{
+    // Decompress blocks back onto the front of the warm rows down to limit
+    std::vector<CellRow> rows;
+
+    while (!m_cold.empty() && m_cold.end() > limit) {
+        index_t end = m_cold.end();
+
+        if (!m_cold.pop(rows))
+            LOGERR("Buffer %p: scrollback rows %" PRIu64 "-%" PRIu64 " lost\n",
+                   this, m_cold.end(), end - 1);
+
+        m_rows.insert(m_rows.begin(), std::make_move_iterator(rows.begin()),
+                      std::make_move_iterator(rows.end()));
+        m_base = m_cold.end();
+    }
+}
+
+CellRow
+TermBuffer::copyRow(index_t i) const
+{
+    CellRow row(m_cold.contains(i) ? m_cold.row(i) : m_rows[i - m_base]);
+    if (row.isPacked())
+        row.unpack(m_attributes);
+    return row;
+}
+
+RowSnapshot
+TermBuffer::snapshotRow(index_t i) const
+{
+    // Writers hold the state lock shared, so they may race to fill the cache
+    pthread_mutex_lock(&m_snapLock);
+    auto &snapshot = m_snapshots[i];
+    if (!snapshot)
+        snapshot = std::make_shared<const CellRow>(copyRow(i));
+    RowSnapshot result = snapshot;
+    pthread_mutex_unlock(&m_snapLock);
+    return result;
+}
+
+const CellRow &
+TermBuffer::textRow(index_t i, CellRow &scratch) const
+{
+    if (m_cold.contains(i)) {
+        scratch = m_cold.row(i);
+        return scratch;
+    }
+    return m_rows[i - m_base];
+}
+
+index_t
+TermBuffer::copyLines(index_t start, index_t count, bool reverse,
+                      std::vector<SearchLine> &lines) const
+{
+    index_t low = lower();
+    CellRow scratch;
+
+    if (start >= m_size) {
+        if (!reverse || m_size == 0)
+            return INVALID_INDEX;
+        start = m_size - 1;
+    }
+    if (start < low) {
+        if (reverse)
+            return INVALID_INDEX;
+        start = low;
+    }
+
+    // Bounds of the logical line containing start
+    index_t first = start, end = start + 1;
+
+    while (first > low && start - first < SEARCH_MAX_CONTINUATION &&
+           textRow(first, scratch).flags & Tsq::Continuation)
+        --first;
+
+    while (count) {
+        while (end < m_size && end - first < SEARCH_MAX_CONTINUATION &&
+               textRow(end, scratch).flags & Tsq::Continuation)
+            ++end;
+
+        SearchLine &line = lines.emplace_back();
+        line.row = first;
+        line.str = textRow(first, scratch).str();
+
+        for (index_t i = first + 1; i < end; ++i) {
+            line.breaks.push_back(line.str.size());
+            line.str.append(textRow(i, scratch).str());
+        }
+
+        count = (count > end - first) ? count - (end - first) : 0;
+
+        if (reverse) {
+            if (first == low)
+                break;
+
+            end = first--;
+            while (first > low && end - first < SEARCH_MAX_CONTINUATION &&
+                   textRow(first, scratch).flags & Tsq::Continuation)
+                --first;
+        } else {
+            if (end == m_size)
+                break;
+
+            first = end++;
+        }
+    }
+
+    return start;
+}
+
 void
 TermBuffer::insertRow(index_t pos)
 {
@@ -85,184 +289,125 @@ TermBuffer::insertRow(index_t pos)
         m_rows.emplace(m_rows.begin() + pos);
         m_rows.pop_front();
 
-        while (pos--)
-            m_changedRows.emplace(pos);
+        m_changedRows.insert(0, pos);
 
         return;
     }
     else if (m_size < m_realsize)
     {
         index_t i = m_size;
-        CellRow save = std::move(m_rows[i & m_capmask]);
+        CellRow save = std::move(slot(i));
 
         while (i > pos) {
-            m_changedRows.emplace(i);
-            m_rows[i & m_capmask] = std::move(m_rows[(i - 1) & m_capmask]);
+            slot(i) = std::move(slot(i - 1));
             --i;
         }
 
-        m_changedRows.emplace(i);
-        m_rows[i & m_capmask] = std::move(save);
+        m_changedRows.insert(pos, m_size + 1);
+        slot(i) = std::move(save);
 
         goto out;
     }
-    else if (m_size < m_capacity)
-    {
-        m_rows.emplace(m_rows.end() - (m_size - pos));
-
-        while (pos <= m_size)
-            m_changedRows.emplace_hint(m_changedRows.end(), pos++);
-
-        goto out2;
-    }
-    else if (pos == m_size)
-    {
-        m_rows[pos & m_capmask].clear();
-        m_changedRows.emplace_hint(m_changedRows.end(), pos);
-    }
-    else
-    {
-        index_t i = m_size;
-        CellRow save = std::move(m_rows[i & m_capmask]);
-
-        while (i > pos) {
-            m_changedRows.emplace(i);
-            m_rows[i & m_capmask] = std::move(m_rows[(i - 1) & m_capmask]);
-            --i;
-        }
 
-        m_changedRows.emplace(i);
-        m_rows[i & m_capmask] = std::move(save);
-        m_rows[i & m_capmask].clear();
-    }
+    m_rows.emplace(m_rows.begin() + (pos - m_base));
+    m_changedRows.insert(pos, m_size + 1);
 
-    while (!m_regionsByStart.empty() &&
+    while (m_size >= m_capacity && !m_regionsByStart.empty() &&
            (m_regionsByStart.begin()->ptr->startRow <= m_size - m_capacity))
         deleteRegion(m_regionsByStart.begin()->ptr);
 
-out2:
     ++m_realsize;
 out:
     ++m_size;
     m_emulator->reportBufferLength(m_id);
 
+    if (index_t limit = packLimit())
+        packRows(limit - 1, limit);
+    freezeRows();
+
     if (m_changedRows.size() > m_screenHeight)
-        m_changedRows.erase(m_changedRows.begin());
+        m_changedRows.popFront();
 }
 
 void
 TermBuffer::deleteRowAndInsertAbove(index_t delpos, index_t addpos)
 {
     index_t i = delpos;
-    CellRow save = std::move(m_rows[i & m_capmask]);
+    CellRow save = std::move(slot(i));
 
     while (i > addpos) {
-        m_changedRows.emplace(i);
-        m_rows[i & m_capmask] = std::move(m_rows[(i - 1) & m_capmask]);
+        slot(i) = std::move(slot(i - 1));
         --i;
     }
 
-    m_changedRows.emplace(i);
-    m_rows[i & m_capmask] = std::move(save);
-    m_rows[i & m_capmask].clear();
+    m_changedRows.insert(addpos, delpos + 1);
+    slot(i) = std::move(save);
+    slot(i).clear();
 }
 
 void
 TermBuffer::deleteRowAndInsertBelow(index_t delpos, index_t addpos)
 {
     index_t i = delpos;
-    CellRow save = std::move(m_rows[i & m_capmask]);
+    CellRow save = std::move(slot(i));
 
     while (i < addpos) {
-        m_changedRows.emplace(i);
-        m_rows[i & m_capmask] = std::move(m_rows[(i + 1) & m_capmask]);
+        slot(i) = std::move(slot(i + 1));
         ++i;
     }
 
-    m_changedRows.emplace(i);
-    m_rows[i & m_capmask] = std::move(save);
-    m_rows[i & m_capmask].clear();
+    m_changedRows.insert(delpos, addpos + 1);
+    slot(i) = std::move(save);
+    slot(i).clear();
 }
 
 void
 TermBuffer::setCaporder(uint8_t caporder)
 {
-    if (m_caporder < caporder) {
-        // Increase caporder
-        index_t pos = m_realsize & m_capmask;
-
-        if (pos < m_rows.size())
-        {
-            if (pos < m_capacity / 2) {
-                // Move elements to back
-                for (index_t i = 0; i < pos; ++i) {
-                    CellRow save = std::move(m_rows.front());
-                    m_rows.pop_front();
-                    m_rows.emplace_back(std::move(save));
-                }
-            } else {
-                // Move elements to front
-                for (index_t i = pos; i < m_capacity; ++i) {
-                    CellRow save = std::move(m_rows.back());
-                    m_rows.pop_back();
-                    m_rows.emplace_front(std::move(save));
-                }
-            }
-        }
+    index_t capacity = 1 << caporder;
+    index_t kept = std::min(capacity, m_capacity);
+    // Rows are renumbered from zero below
+    index_t delta = m_size > kept ? m_size - kept : 0;
+
+    // Remove saved rows
+    while (m_realsize > m_size) {
+        m_rows.pop_back();
+        --m_realsize;
+    }
 
-        // Remove saved rows
-        while (m_realsize > m_size) {
-            m_rows.pop_back();
-            --m_realsize;
-        }
+    // Cold rows are only renumbered, a block straddling delta keeps
+    // just the rows above it
+    if (m_base < delta) {
+        m_rows.erase(m_rows.begin(), m_rows.begin() + (delta - m_base));
+        m_base = delta;
+        m_cold.reset(0);
     } else {
-        // Decrease caporder
-        // Find the two ends
-        index_t capacity = 1 << caporder;
-        index_t end = m_size & m_capmask;
-        index_t start = (m_size > capacity) ? (end - capacity) & m_capmask : 0;
-
-        if (end >= start) {
-            // Remove elements from back
-            m_rows.erase(m_rows.begin() + end, m_rows.end());
-            // Remove elements from front
-            m_rows.erase(m_rows.begin(), m_rows.begin() + start);
-        } else {
-            // Remove elements from middle
-            m_rows.erase(m_rows.begin() + end, m_rows.begin() + start);
-            // Move elements to back
-            for (index_t i = 0; i < end; ++i) {
-                CellRow save = std::move(m_rows.front());
-                m_rows.pop_front();
-                m_rows.emplace_back(std::move(save));
-            }
-        }
+        m_cold.rebase(delta);
     }
+    m_base -= delta;
+    m_packResume = 0;
 
     // Adjust regions
-    m_size -= m_rows.size();
     m_changedRegions.clear();
 
-    if (m_size) {
-        while (!m_regionsByStart.empty() && m_regionsByStart.begin()->ptr->startRow < m_size)
+    if (delta) {
+        while (!m_regionsByStart.empty() && m_regionsByStart.begin()->ptr->startRow < delta)
             deleteRegion(m_regionsByStart.begin()->ptr);
         for (const auto &i: m_regionsByStart)
-            i.ptr->startRow -= m_size;
+            i.ptr->startRow -= delta;
         for (const auto &i: m_regionsByEnd)
-            i.ptr->endRow -= m_size;
+            i.ptr->endRow -= delta;
     }
 
-    pullRegions(m_rows.size() - m_screenHeight, m_rows.size(), m_changedRegions);
-
     // Set new size and capacity
-    m_size = m_realsize = m_rows.size();
-    m_capacity = 1 << caporder;
-    m_capmask = m_capacity - 1;
+    m_size = m_realsize = m_size - delta;
+    m_capacity = capacity;
     m_caporder = caporder;
 
+    pullRegions(m_size - m_screenHeight, m_size, m_changedRegions);
+
     m_changedRows.clear();
-    for (unsigned i = 1; i <= m_screenHeight; ++i)
-        m_changedRows.insert(m_size - i);
+    m_changedRows.insert(m_size - m_screenHeight, m_size);
 }
 
 bool
@@ -286,6 +431,7 @@ int
 TermBuffer::setScreenHeight(unsigned screenHeight, unsigned maxChop)
 {
     int added = 0, removed = 0;
+    index_t packed = packLimit();
 
     if (m_capacity < screenHeight) {
         uint8_t caporder = m_caporder;
@@ -309,7 +455,7 @@ TermBuffer::setScreenHeight(unsigned screenHeight, unsigned maxChop)
                 m_rows.emplace_back();
                 ++m_realsize;
             }
-            m_changedRows.emplace_hint(m_changedRows.end(), m_size);
+            m_changedRows.insert(m_size);
             ++m_size;
             ++added;
         }
@@ -319,20 +465,17 @@ TermBuffer::setScreenHeight(unsigned screenHeight, unsigned maxChop)
 
             if (m_size < m_realsize)
                 goto next;
-            else if (m_size < m_capacity)
-                m_rows.emplace_back();
-            else
-                m_rows[m_size & m_capmask].clear();
 
+            m_rows.emplace_back();
             ++m_realsize;
         next:
-            m_changedRows.emplace_hint(m_changedRows.end(), m_size);
+            m_changedRows.insert(m_size);
             ++m_size;
         }
 
         // try to chop empty rows instead of scrolling up
         for (unsigned i = screenHeight; maxChop && i < m_screenHeight; ++i) {
-            CellRow &row = m_rows[(m_size - 1) & m_capmask];
+            CellRow &row = slot(m_size - 1);
             if (!row.isEmpty())
                 break;
 
@@ -350,9 +493,13 @@ TermBuffer::setScreenHeight(unsigned screenHeight, unsigned maxChop)
     m_screenHeight = screenHeight;
     if (added || removed)
         m_emulator->reportBufferLength(m_id);
+    if (!m_noScrollback) {
+        packRows(packed, packLimit());
+        thawRows(coldLimit());
+        freezeRows();
+    }
 
-    while (m_changedRows.size() > screenHeight)
-        m_changedRows.erase(m_changedRows.begin());
+    m_changedRows.truncate(screenHeight);
 
     return added;
 }
@@ -362,9 +509,13 @@ TermBuffer::clear()
 {
     // Note: this should be called for alternate buffer only
     m_rows.clear();
+    m_attributes.clear();
+    m_packResume = 0;
+    m_base = 0;
+    m_cold.reset(0);
 
     while (m_rows.size() < m_size) {
-        m_changedRows.emplace_hint(m_changedRows.end(), m_rows.size());
+        m_changedRows.insert(m_rows.size());
         m_rows.emplace_back();
     }
 
@@ -377,25 +528,13 @@ TermBuffer::clearScrollback()
     if (m_size == m_screenHeight)
         return false;
 
-    // Find the two ends
-    index_t end = m_size & m_capmask;
-    index_t start = (end - m_screenHeight) & m_capmask;
-
-    if (end >= start) {
-        // Remove elements from back
-        m_rows.erase(m_rows.begin() + end, m_rows.end());
-        // Remove elements from front
-        m_rows.erase(m_rows.begin(), m_rows.begin() + start);
-    } else {
-        // Remove elements from middle
-        m_rows.erase(m_rows.begin() + end, m_rows.begin() + start);
-        // Move elements to back
-        for (index_t i = 0; i < end; ++i) {
-            CellRow save = std::move(m_rows.front());
-            m_rows.pop_front();
-            m_rows.emplace_back(std::move(save));
-        }
+    // Keep only the screen rows
+    while (m_realsize > m_size) {
+        m_rows.pop_back();
+        --m_realsize;
     }
+    m_rows.erase(m_rows.begin(), m_rows.end() - m_screenHeight);
+    m_base = 0;
 
     // Adjust regions
     m_size -= m_screenHeight;
@@ -415,9 +554,14 @@ TermBuffer::clearScrollback()
     // Set new size
     m_size = m_realsize = m_screenHeight;
 
+    // Drop attributes held only by scrollback
+    m_cold.reset(0);
+    unpackRows();
+    m_attributes.clear();
+    m_packResume = 0;
+
     m_changedRows.clear();
-    for (index_t i = 0; i < m_size; ++i)
-        m_changedRows.insert(i);
+    m_changedRows.insert(0, m_size);
 
     m_emulator->reportBufferCapacity(m_id);
     return true;
@@ -4,14 +4,19 @@
 
 #pragma once
 
-#include "cell.h"
+#include "attrtable.h"
+#include "coldstore.h"
 #include "region.h"
+#include "rowset.h"
 
 #include <deque>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <pthread.h>
 
 class TermEmulator;
+struct SearchLine;
 
 class TermBuffer
 {
@@ -20,7 +25,8 @@ private:
     index_t m_size;
     index_t m_realsize;
     index_t m_capacity;
-    index_t m_capmask;
+    // First row held in m_rows, older ones are in m_cold
+    index_t m_base = 0;
     const int32_t *m_modTimePtr;
     unsigned m_screenHeight;
     uint8_t m_id;
@@ -29,16 +35,33 @@ private:
     regionid_t m_nextRegionId = 0;
 
     std::deque<CellRow> m_rows;
-    std::set<index_t> m_changedRows;
+    AttributeTable m_attributes;
+    index_t m_packResume = 0;
+    ColdStore m_cold;
+    RowSet m_changedRows;
 
     std::set<bufreg_t> m_changedRegions;
     std::map<regionid_t,Region*> m_regions;
     std::set<RegionRef,RegionStartSorter> m_regionsByStart;
     std::set<RegionRef,RegionEndSorter> m_regionsByEnd;
 
+    // Discarded whenever the emulator takes the state lock for writing
+    mutable pthread_mutex_t m_snapLock;
+    mutable std::unordered_map<index_t,RowSnapshot> m_snapshots;
+
     void setCaporder(uint8_t caporder);
     void deleteRegion(Region *region);
 
+    inline CellRow& slot(index_t i) { return m_rows[i - m_base]; }
+    inline CellRow& liveRow(index_t i);
+    inline index_t packLimit() const;
+    index_t coldLimit() const;
+    void packRows(index_t start, index_t end);
+    bool sweepAttributes();
+    void unpackRows();
+    void freezeRows();
+    void thawRows(index_t limit);
+
 public:
     TermBuffer(TermEmulator *emulator, unsigned screenHeight,
                uint8_t caporder, uint8_t id);
@@ -48,12 +71,23 @@ public:
     inline const TermEmulator* emulator() const { return m_emulator; }
     inline index_t size() const { return m_size; }
     inline index_t capacity() const { return m_capacity; }
+    // Lowest row still retained
+    inline index_t lower() const { return m_size > m_capacity ? m_size - m_capacity : 0; }
     inline unsigned screenHeight() const { return m_screenHeight; }
     inline uint8_t id() const { return m_id; }
     inline uint8_t caporder() const { return m_caporder|m_noScrollback; }
     inline bool noScrollback() const { return m_noScrollback != 0; }
 
+    // Warm rows only; use copyRow for arbitrary scrollback
     inline const CellRow& constRow(index_t i) const;
+    CellRow copyRow(index_t i) const;
+    // Requires the state lock for reading
+    RowSnapshot snapshotRow(index_t i) const;
+    // Text and flags of any row without unpacking it, scratch holds cold rows
+    const CellRow& textRow(index_t i, CellRow &scratch) const;
+    // Copies logical lines for searching, returns the clamped start row
+    index_t copyLines(index_t start, index_t count, bool reverse,
+                      std::vector<SearchLine> &lines) const;
     inline CellRow& rawRow(index_t i);
     inline CellRow& row(index_t i);
     inline CellRow& singleRow(index_t i);
@@ -86,35 +120,54 @@ public:
     bool removeUserRegion(regionid_t region);
 };
 
+inline CellRow &
+TermBuffer::liveRow(index_t i)
+{
+    if (m_cold.contains(i))
+        thawRows(i);
+
+    CellRow &row = slot(i);
+    if (row.isPacked())
+        row.unpack(m_attributes);
+    return row;
+}
+
+inline index_t
+TermBuffer::packLimit() const
+{
+    // Rows more than a screen above the screen are packed
+    return m_size > 2 * m_screenHeight ? m_size - 2 * m_screenHeight : 0;
+}
+
 inline const CellRow &
 TermBuffer::constRow(index_t i) const
 {
-    return m_rows[i & m_capmask];
+    return m_rows[i - m_base];
 }
 
 inline CellRow &
 TermBuffer::rawRow(index_t i)
 {
-    return m_rows[i & m_capmask];
+    return liveRow(i);
 }
 
 inline CellRow &
 TermBuffer::row(index_t i)
 {
-    m_changedRows.emplace_hint(m_changedRows.end(), i);
+    m_changedRows.insert(i);
+    CellRow &row = liveRow(i);
+    row.modtime = *m_modTimePtr;
 
     // Clear continuation bit on following line
     if (i < m_size - 1) {
-        CellRow &next = m_rows[(i + 1) & m_capmask];
+        CellRow &next = slot(i + 1);
         if (next.flags) {
-            m_changedRows.emplace_hint(m_changedRows.end(), i + 1);
+            m_changedRows.insert(i + 1);
             next.modtime = *m_modTimePtr;
             next.flags &= ~Tsq::Continuation;
         }
     }
 
-    CellRow &row = m_rows[i & m_capmask];
-    row.modtime = *m_modTimePtr;
     return row;
 }
 
@@ -122,8 +175,8 @@ inline CellRow &
 TermBuffer::singleRow(index_t i)
 {
     // No continuation check
-    m_changedRows.emplace_hint(m_changedRows.end(), i);
-    CellRow &row = m_rows[i & m_capmask];
+    m_changedRows.insert(i);
+    CellRow &row = liveRow(i);
     row.modtime = *m_modTimePtr;
     return row;
 }
@@ -131,7 +184,7 @@ TermBuffer::singleRow(index_t i)
 inline void
 TermBuffer::touchRow(CellRow *row, index_t i)
 {
-    m_changedRows.emplace_hint(m_changedRows.end(), i);
+    m_changedRows.insert(i);
     row->modtime = *m_modTimePtr;
 }
 
@@ -147,4 +200,5 @@ TermBuffer::resetEventState()
 {
     m_changedRows.clear();
     m_changedRegions.clear();
+    m_snapshots.clear();
 }
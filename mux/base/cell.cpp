@@ -4,6 +4,7 @@
 
 #include "common.h"
 #include "cell.h"
+#include "attrtable.h"
 #include "lib/unicode.h"
 #include "lib/utf8.h"
 
@@ -410,6 +411,40 @@ out:
     return m_str.size();
 }
 
+size_t
+CellRow::append(const CellAttributes &a, const char *str, unsigned n)
+{
+    // Single-width ASCII append of n cells
+
+    m_str.append(str, n);
+
+    if (!m_ranges.empty())
+    {
+        // Get the last range
+        auto range = m_ranges.data() + (m_ranges.size() - RANGE_SIZE);
+
+        // Should new cells be included?
+        if (m_clusters - 1 == RANGE_END && a == RANGE_ATTR) {
+            RANGE_END += n;
+            goto out;
+        }
+    }
+    if (a.flags) {
+        // Start a new range
+        m_ranges.push_back(m_clusters);
+        m_ranges.push_back(m_clusters + n - 1);
+        m_ranges.push_back(a.flags);
+        m_ranges.push_back(a.fg);
+        m_ranges.push_back(a.bg);
+        m_ranges.push_back(a.link);
+    }
+out:
+    m_clusters += n;
+    m_columns += n;
+
+    return m_str.size();
+}
+
 void
 CellRow::insert(int x, Tsq::Unicoding *lookup)
 {
@@ -723,3 +758,97 @@ CellRow::substr(unsigned startPos, Tsq::Unicoding *lookup) const
 
     return std::string(P2I(i), P2I(j));
 }
+
+/*
+ * Packing
+ */
+bool
+CellRow::pack(AttributeTable &table)
+{
+    // Packed range: start and end in one word, attribute id in the next
+    std::vector<uint32_t> packed;
+    packed.reserve(m_ranges.size() / 3);
+
+    m_str.shrink_to_fit();
+
+    FOR_RANGES(m_ranges)
+    {
+        int id = 0;
+
+        if (RANGE_END > 0xffff || (id = table.intern(RANGE_ATTR)) < 0) {
+            // Leave ranges unpacked, only a full table is a failure
+            m_ranges.shrink_to_fit();
+            return id == 0;
+        }
+
+        packed.push_back(RANGE_START | (RANGE_END << 16));
+        packed.push_back(id);
+    }
+
+    if (!packed.empty())
+        m_clusters |= CELLROW_PACKED;
+
+    m_ranges.swap(packed);
+    return true;
+}
+
+void
+CellRow::unpack(const AttributeTable &table)
+{
+    std::vector<uint32_t> ranges;
+    ranges.reserve(m_ranges.size() * 3);
+
+    for (size_t i = 0; i < m_ranges.size(); i += 2) {
+        const CellAttributes &a = table.at(m_ranges[i + 1]);
+        ranges.push_back(m_ranges[i] & 0xffff);
+        ranges.push_back(m_ranges[i] >> 16);
+        ranges.push_back(a.flags);
+        ranges.push_back(a.fg);
+        ranges.push_back(a.bg);
+        ranges.push_back(a.link);
+    }
+
+    m_clusters &= ~CELLROW_PACKED;
+    m_ranges.swap(ranges);
+}
+
+void
+CellRow::markAttributes(std::vector<bool> &live) const
+{
+    if (isPacked())
+        for (size_t i = 1; i < m_ranges.size(); i += 2)
+            live[m_ranges[i]] = true;
+}
+
+void
+CellRow::serialize(std::string &buf) const
+{
+    uint32_t hdr[6] = {
+        m_clusters, (uint32_t)m_columns, flags, (uint32_t)modtime,
+        (uint32_t)m_ranges.size(), (uint32_t)m_str.size()
+    };
+
+    buf.append((const char *)hdr, sizeof(hdr));
+    buf.append((const char *)m_ranges.data(), m_ranges.size() * 4);
+    buf.append(m_str);
+}
+
+const char *
+CellRow::deserialize(const char *ptr)
+{
+    uint32_t hdr[6];
+    memcpy(hdr, ptr, sizeof(hdr));
+    ptr += sizeof(hdr);
+
+    m_clusters = hdr[0];
+    m_columns = hdr[1];
+    flags = hdr[2];
+    modtime = hdr[3];
+
+    m_ranges.resize(hdr[4]);
+    memcpy(m_ranges.data(), ptr, hdr[4] * 4);
+    ptr += hdr[4] * 4;
+
+    m_str.assign(ptr, hdr[5]);
+    return ptr + hdr[5];
+}
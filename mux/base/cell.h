@@ -10,8 +10,12 @@
 #include "color.h"
 
 #include <vector>
+#include <memory>
 
 namespace Tsq { class Unicoding; }
+class AttributeTable;
+
+#define CELLROW_PACKED 0x80000000u
 
 struct CellAttributes
 {
@@ -30,6 +34,9 @@ struct CellAttributes
     inline bool operator==(const uint32_t *ptr) const {
         return ptr[0] == flags && ptr[1] == fg && ptr[2] == bg && ptr[3] == link;
     }
+    inline bool operator==(const CellAttributes &o) const {
+        return o.flags == flags && o.fg == fg && o.bg == bg && o.link == link;
+    }
 };
 
 class CellRow
@@ -64,8 +71,19 @@ public:
     inline const std::string& str() const { return m_str; }
     inline int32_t columns() const { return m_columns; }
     inline bool isEmpty() const { return m_clusters == 0; }
+    inline bool isPacked() const { return m_clusters & CELLROW_PACKED; }
     inline uint32_t numRanges() const { return m_ranges.size() / 6; }
 
+    // Packed rows are read-only: str() is valid but ranges are encoded
+    // Returns false if the table is full
+    bool pack(AttributeTable &table);
+    void unpack(const AttributeTable &table);
+    void markAttributes(std::vector<bool> &live) const;
+
+    // Flat encoding used by compressed scrollback
+    void serialize(std::string &buf) const;
+    const char* deserialize(const char *ptr);
+
     std::string substr(unsigned startPos, Tsq::Unicoding *lookup) const;
     std::string substr(unsigned startPos, unsigned endPos,
                        Tsq::Unicoding *lookup) const;
@@ -75,6 +93,7 @@ public:
     void pad(unsigned n);
     void combine(Cursor &cursor, const CellAttributes &a, codepoint_t c);
     size_t append(const CellAttributes &a, codepoint_t c, int width);
+    size_t append(const CellAttributes &a, const char *str, unsigned n);
     size_t replace(Cursor &cursor, const CellAttributes &a, codepoint_t c,
                    int width, Tsq::Unicoding *lookup);
 
@@ -90,6 +109,9 @@ public:
     void clear();
 };
 
+// Immutable copy of a row, shared by all writers until the row changes
+typedef std::shared_ptr<const CellRow> RowSnapshot;
+
 inline void
 CellRow::erase()
 {
@@ -0,0 +1,321 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "coldstore.h"
+#include "exception.h"
+#include "os/dir.h"
+#include "os/logging.h"
+#include "config.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <zlib.h>
+
+ColdStore::ColdStore()
+{
+    int rc = pthread_mutex_init(&m_lock, NULL);
+    if (rc < 0)
+        throw ErrnoException("pthread_mutex_init", errno);
+}
+
+ColdStore::ColdStore(const ColdStore &copyfrom) :
+    m_blocks(copyfrom.m_blocks),
+    m_start(copyfrom.m_start),
+    m_end(copyfrom.m_end),
+    m_skip(copyfrom.m_skip),
+    m_window(copyfrom.m_window)
+{
+    int rc = pthread_mutex_init(&m_lock, NULL);
+    if (rc < 0)
+        throw ErrnoException("pthread_mutex_init", errno);
+
+    // Bring spilled blocks into memory, they will be spilled again
+    for (size_t i = 0; i < copyfrom.m_spilled; ++i) {
+        Block &block = m_blocks[i];
+        block.data.resize(block.length);
+
+        if (pread(copyfrom.m_fd, &block.data[0], block.length, block.offset) != (ssize_t)block.length)
+            throw ErrnoException("pread", errno);
+    }
+}
+
+ColdStore::~ColdStore()
+{
+    unmap();
+    if (m_fd != -1)
+        close(m_fd);
+
+    pthread_mutex_destroy(&m_lock);
+}
+
+void
+ColdStore::unmap() const
+{
+    if (m_map) {
+        munmap(m_map, m_mapSize);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+}
+
+const char *
+ColdStore::blockData(const Block &block) const
+{
+    if (!block.data.empty())
+        return block.data.data();
+
+    // Map a view of the spill file around the block
+    if (block.offset < m_mapOffset || block.offset + block.length > m_mapOffset + m_mapSize)
+    {
+        static const uint64_t pagemask = sysconf(_SC_PAGESIZE) - 1;
+        unmap();
+
+        m_mapOffset = block.offset & ~pagemask;
+        size_t size = block.offset + block.length - m_mapOffset;
+        void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, m_fd, m_mapOffset);
+        if (map == MAP_FAILED)
+            return nullptr;
+
+        m_map = (char *)map;
+        m_mapSize = size;
+    }
+
+    return m_map + (block.offset - m_mapOffset);
+}
+
+bool
+ColdStore::decode(const Block &block, std::vector<CellRow> &rows) const
+{
+    const char *data = blockData(block);
+    rows.resize(SCROLLBACK_BLOCK_ROWS);
+
+    uint32_t rawsize;
+    std::string raw;
+    uLongf len;
+    int rc;
+
+    if (!data) {
+        LOGERR("Scrollback block unreadable: map failed (%d)\n", errno);
+        goto err;
+    }
+
+    memcpy(&rawsize, data, 4);
+    raw.resize(rawsize);
+    len = rawsize;
+
+    rc = uncompress((Bytef *)&raw[0], &len, (const Bytef *)data + 4, block.length - 4);
+    if (rc != Z_OK) {
+        LOGERR("Scrollback block unreadable: uncompress failed (%d)\n", rc);
+        goto err;
+    }
+
+    data = raw.data();
+    for (auto &row: rows)
+        data = row.deserialize(data);
+    return true;
+err:
+    for (auto &row: rows)
+        row.clear();
+    return false;
+}
+
+void
+ColdStore::spill()
+{
+    Block &block = m_blocks[m_spilled];
+
+    try {
+        if (m_fd == -1)
+            m_fd = osCreateSpillFile();
+    }
+    catch (const std::exception &e) {
+        LOGERR("Scrollback spill disabled: %s\n", e.what());
+        m_window = 0;
+        return;
+    }
+
+    if (pwrite(m_fd, block.data.data(), block.length, m_fileEnd) != (ssize_t)block.length) {
+        LOGERR("Scrollback spill disabled: write failed (%d)\n", errno);
+        m_window = 0;
+        return;
+    }
+
+    block.offset = m_fileEnd;
+    m_fileEnd += block.length;
+    std::string().swap(block.data);
+    ++m_spilled;
+}
+
+void
+ColdStore::truncate()
+{
+    // Nothing left on disk: start the file over
+    unmap();
+    if (m_fileEnd) {
+        if (ftruncate(m_fd, 0) != 0)
+            LOGERR("Scrollback spill truncate failed (%d)\n", errno);
+        m_fileEnd = 0;
+    }
+}
+
+void
+ColdStore::reset(index_t start)
+{
+    m_blocks.clear();
+    m_start = m_end = start;
+    m_skip = 0;
+    m_cacheBlock = nullptr;
+    m_spilled = 0;
+    truncate();
+}
+
+void
+ColdStore::push(const std::vector<CellRow> &rows)
+{
+    std::string raw;
+    for (const auto &row: rows)
+        row.serialize(raw);
+
+    uint32_t rawsize = raw.size();
+    uLongf len = compressBound(rawsize);
+    Block block;
+    block.data.resize(4 + len);
+    memcpy(&block.data[0], &rawsize, 4);
+
+    if (compress2((Bytef *)&block.data[4], &len,
+                  (const Bytef *)raw.data(), rawsize, Z_BEST_SPEED) != Z_OK)
+        throw std::bad_alloc();
+
+    block.data.resize(4 + len);
+    block.data.shrink_to_fit();
+    block.length = 4 + len;
+    m_blocks.emplace_back(std::move(block));
+    m_end += SCROLLBACK_BLOCK_ROWS;
+
+    while (m_window && m_blocks.size() - m_spilled > m_window)
+        spill();
+}
+
+bool
+ColdStore::pop(std::vector<CellRow> &rows)
+{
+    const Block &block = m_blocks.back();
+    bool rc = decode(block, rows);
+
+    if (m_cacheBlock == &block)
+        m_cacheBlock = nullptr;
+
+    if (m_blocks.size() == 1) {
+        rows.erase(rows.begin(), rows.begin() + m_skip);
+        m_end = m_start;
+        m_skip = 0;
+    } else {
+        m_end -= SCROLLBACK_BLOCK_ROWS;
+    }
+
+    m_blocks.pop_back();
+
+    if (m_spilled > m_blocks.size() && (m_spilled = m_blocks.size()) == 0)
+        truncate();
+
+    return rc;
+}
+
+bool
+ColdStore::shift(std::vector<CellRow> &rows)
+{
+    bool rc = decode(m_blocks.front(), rows);
+    rows.erase(rows.begin(), rows.begin() + m_skip);
+    dropFront();
+    return rc;
+}
+
+void
+ColdStore::dropFront()
+{
+    const Block &block = m_blocks.front();
+
+    if (m_spilled) {
+#ifdef FALLOC_FL_PUNCH_HOLE
+        fallocate(m_fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE,
+                  block.offset, block.length);
+#endif
+        if (--m_spilled == 0)
+            truncate();
+    }
+
+    if (m_cacheBlock == &block)
+        m_cacheBlock = nullptr;
+
+    m_blocks.pop_front();
+    m_start += SCROLLBACK_BLOCK_ROWS - m_skip;
+    m_skip = 0;
+}
+
+void
+ColdStore::dropBelow(index_t i)
+{
+    while (!m_blocks.empty() && m_start + SCROLLBACK_BLOCK_ROWS - m_skip <= i)
+        dropFront();
+}
+
+void
+ColdStore::rebase(index_t delta)
+{
+    dropBelow(delta);
+
+    if (empty()) {
+        m_start = m_end = 0;
+        m_skip = 0;
+    } else {
+        // A block straddling delta keeps its rows, the ones below are skipped
+        if (m_start < delta) {
+            m_skip += delta - m_start;
+            m_start = delta;
+        }
+        m_start -= delta;
+        m_end -= delta;
+    }
+}
+
+CellRow
+ColdStore::row(index_t i) const
+{
+    index_t offset = i - m_start + m_skip;
+    const Block *block = &m_blocks[offset / SCROLLBACK_BLOCK_ROWS];
+
+    pthread_mutex_lock(&m_lock);
+
+    if (m_cacheBlock != block) {
+        // Failed blocks are not cached, so the next read retries
+        bool rc = decode(*block, m_cache);
+        m_cacheBlock = rc ? block : nullptr;
+    }
+
+    CellRow result(m_cache[offset % SCROLLBACK_BLOCK_ROWS]);
+
+    pthread_mutex_unlock(&m_lock);
+    return result;
+}
+
+void
+ColdStore::markAttributes(std::vector<bool> &live) const
+{
+    std::vector<CellRow> rows;
+
+    pthread_mutex_lock(&m_lock);
+
+    // Rows of unreadable blocks are lost and hold nothing
+    unsigned skip = m_skip;
+    for (const auto &block: m_blocks) {
+        if (decode(block, rows))
+            for (auto i = rows.begin() + skip; i != rows.end(); ++i)
+                i->markAttributes(live);
+        skip = 0;
+    }
+
+    pthread_mutex_unlock(&m_lock);
+}
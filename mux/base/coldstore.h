@@ -0,0 +1,81 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "cell.h"
+
+#include <deque>
+#include <pthread.h>
+
+//
+// Compressed blocks of old scrollback rows
+// Covers a contiguous range of rows, in units of SCROLLBACK_BLOCK_ROWS
+// except that leading rows of the first block may have been dropped
+// Optionally spills the oldest blocks to an unlinked file in the runtime dir
+//
+class ColdStore
+{
+private:
+    struct Block {
+        std::string data;
+        uint64_t offset;
+        uint32_t length;
+    };
+
+    std::deque<Block> m_blocks;
+    index_t m_start = 0;
+    index_t m_end = 0;
+    // Rows of the first block that precede m_start
+    unsigned m_skip = 0;
+
+    // Spill file: the first m_spilled blocks live on disk
+    size_t m_window = 0;
+    size_t m_spilled = 0;
+    int m_fd = -1;
+    uint64_t m_fileEnd = 0;
+
+    // Most recently decompressed block, plus the spill file view
+    mutable pthread_mutex_t m_lock;
+    mutable std::vector<CellRow> m_cache;
+    mutable const Block *m_cacheBlock = nullptr;
+    mutable char *m_map = nullptr;
+    mutable uint64_t m_mapOffset = 0;
+    mutable size_t m_mapSize = 0;
+
+    const char* blockData(const Block &block) const;
+    bool decode(const Block &block, std::vector<CellRow> &rows) const;
+    void unmap() const;
+    void spill();
+    void truncate();
+    void dropFront();
+
+public:
+    ColdStore();
+    ColdStore(const ColdStore &copyfrom);
+    ~ColdStore();
+
+    inline index_t start() const { return m_start; }
+    inline index_t end() const { return m_end; }
+    inline bool empty() const { return m_start == m_end; }
+    inline bool contains(index_t i) const { return i >= m_start && i < m_end; }
+    inline size_t spilled() const { return m_spilled; }
+
+    // Maximum number of blocks kept in memory (0 to disable spilling)
+    inline void setWindow(size_t window) { m_window = window; }
+
+    void reset(index_t start);
+    void push(const std::vector<CellRow> &rows);
+    // Decoding the remaining rows of the first or last block,
+    // false if they were lost
+    bool pop(std::vector<CellRow> &rows);
+    bool shift(std::vector<CellRow> &rows);
+    void dropBelow(index_t i);
+    // Renumber rows after the buffer has moved its origin up to delta
+    // Rows below delta are dropped
+    void rebase(index_t delta);
+
+    CellRow row(index_t i) const;
+    void markAttributes(std::vector<bool> &live) const;
+};
@@ -22,12 +22,14 @@
 #include "mounttask.h"
 #include "exception.h"
 #include "parsemap.h"
+#include "rowsearch.h"
 #include "lib/protocol.h"
 #include "lib/wire.h"
 #include "lib/attrstr.h"
 #include "os/attr.h"
 #include "os/time.h"
 #include "os/logging.h"
+#include "config.h"
 
 void
 TermReader::disconnect()
@@ -446,6 +448,10 @@ TermReader::commandClientAnnounce(const char *body, uint32_t length)
             return;
         }
 
+        // Directly connected clients can apply row diffs
+        if (hops == 0 && version >= CLIENT_VERSION_ROWDIFF)
+            m_writer->enableRowDiffs();
+
         // Send all current terminal data to client
         for (const auto &i: m_terms)
             if (i.second->isTermWatch)
@@ -649,6 +655,49 @@ TermReader::commandTermGetRows(ConnWatch *watch, const char *body, uint32_t leng
     m_writer->submitResponse(std::move(m.result()));
 }
 
+void
+TermReader::commandTermSearchRows(ConnWatch *watch, const char *body, uint32_t length)
+{
+    if (!watch->isTermWatch)
+        return;
+
+    Tsq::ProtocolUnmarshaler unm(body + 32, length - 32);
+    unsigned spec = unm.parseNumber();
+    index_t start = unm.parseNumber64();
+    index_t count = unm.parseNumber64();
+    unsigned limit = unm.parseNumber();
+    std::string pattern = unm.parseString();
+    std::vector<RowMatch> results;
+    index_t next;
+
+    if (count > SEARCH_MAX_ROWS)
+        count = SEARCH_MAX_ROWS;
+    if (limit == 0 || limit > SEARCH_MAX_RESULTS)
+        limit = SEARCH_MAX_RESULTS;
+
+    try {
+        RowSearch search(pattern, spec >> 8);
+        next = static_cast<TermWatch*>(watch)->term()->commandSearchRows(
+            spec & 0xff, search, start, count, spec & (TSQ_SEARCH_REVERSE << 8),
+            limit, results);
+    } catch (const std::regex_error &) {
+        LOGDBG("Reader %p: bad search pattern\n", this);
+        next = INVALID_INDEX;
+    }
+
+    Tsq::ProtocolMarshaler m(TSQ_SEARCH_ROWS_RESPONSE);
+    m.addUuidPairReversed(body);
+    m.addNumber(spec & 0xff);
+    m.addNumber64(next);
+
+    for (const auto &match: results) {
+        m.addNumber64(match.row);
+        m.addNumberPair(match.start, match.end);
+    }
+
+    m_writer->submitResponse(std::move(m.result()));
+}
+
 void
 TermReader::commandTermGetImage(ConnWatch *watch, const char *body, uint32_t length)
 {
@@ -872,6 +921,9 @@ TermReader::handleTermCommand(uint32_t command, uint32_t length, const char *bod
         case TSQ_IMAGE_CONTENT:
             commandTermGetImage(watch, body, length);
             break;
+        case TSQ_SEARCH_ROWS:
+            commandTermSearchRows(watch, body, length);
+            break;
         case TSQ_DOWNLOAD_IMAGE:
             commandTermDownloadImage(watch, body, length);
             break;
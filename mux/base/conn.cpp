@@ -20,7 +20,7 @@
 #include <cassert>
 
 ConnInstance::ConnInstance(const char *name, bool isTerm) :
-    AttributeBase(name),
+    AttributeBase(name, ThreadBaseFd|(isTerm ? ThreadBasePoolable : 0)),
     m_output(new TermOutput(this)),
     m_isTerm(isTerm)
 {
@@ -45,6 +45,7 @@ public:
     inline size_t& rptr() { return m_ptr; }
     inline int32_t& rpos() { return m_pos; }
     inline void incPos() { m_savedPos = m_pos++; }
+    inline void incPos(int n) { m_savedPos = m_pos + n - 1; m_pos += n; }
 
     inline uint8_t subpos() const { return m_flags & 0xff; }
     inline void incSubpos() { ++m_flags; }
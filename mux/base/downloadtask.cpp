@@ -9,10 +9,12 @@
 #include "os/fd.h"
 #include "os/dir.h"
 #include "os/logging.h"
+#include "os/time.h"
 #include "lib/wire.h"
 #include "lib/protocol.h"
 
 #include <unistd.h>
+#include <fcntl.h>
 
 #define HEADERSIZE 60
 
@@ -24,6 +26,7 @@ FileDownload::setup(Tsq::ProtocolUnmarshaler *unm)
 {
     m_chunkSize = unm->parseNumber();
     m_windowSize = unm->parseNumber();
+    m_window = new TaskWindow(m_chunkSize, m_windowSize);
 
     uint32_t command = htole32(TSQ_TASK_OUTPUT);
     uint32_t status = htole32(Tsq::TaskRunning);
@@ -53,6 +56,7 @@ FileDownload::FileDownload(Tsq::ProtocolUnmarshaler *unm, unsigned flags) :
 
 FileDownload::~FileDownload()
 {
+    delete m_window;
     delete [] m_buf;
 }
 
@@ -69,6 +73,7 @@ FileDownload::handleData(std::string *data)
 
     Tsq::ProtocolUnmarshaler unm(data->data(), data->size());
     m_acked = unm.parseNumber64();
+    m_window->acked(m_acked, osMonotime());
     delete data;
 
     if (!m_running) {
@@ -80,7 +85,7 @@ FileDownload::handleData(std::string *data)
 bool
 FileDownload::handleFd()
 {
-    if (m_sent - m_acked >= m_windowSize * m_chunkSize) {
+    if (!m_window->open(m_sent, m_acked)) {
         // Stop and wait for ack message
         m_running = false;
         enablefd(false);
@@ -97,6 +102,7 @@ FileDownload::handleFd()
 
         std::string buf(m_buf, HEADERSIZE + rc);
         m_sent += rc;
+        m_window->sent(m_sent, m_acked, osMonotime());
 
         if (!throttledOutput(buf)) {
             LOGDBG("Download %p: throttled (local)\n", this);
@@ -104,7 +110,8 @@ FileDownload::handleFd()
             enablefd(false);
         }
         if (rc == 0) {
-            LOGDBG("Download %p: finished\n", this);
+            LOGDBG("Download %p: finished (%zu bytes, %" PRIu64 " B/s, window %zu, rtt %" PRId64 "ms)\n",
+                   this, m_sent, m_window->rate(), m_window->window(), m_window->rtt());
             return false;
         }
     }
@@ -155,6 +162,9 @@ FileDownload::openfd()
 
     try {
         setfd(osOpenFile(m_targetName.c_str(), &total, &mode));
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
     } catch (const std::exception &e) {
         // Fail
         reportError(Tsq::DownloadTaskErrorOpenFailed, strerror(errno));
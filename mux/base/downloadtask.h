@@ -5,6 +5,7 @@
 #pragma once
 
 #include "taskbase.h"
+#include "taskwindow.h"
 
 //
 // Download from file
@@ -20,6 +21,7 @@ private:
 
     size_t m_sent = 0;
     size_t m_acked = 0;
+    TaskWindow *m_window;
 
     bool m_running = false;
 
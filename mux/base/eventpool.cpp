@@ -0,0 +1,208 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "eventpool.h"
+#include "threadbase.h"
+#include "exception.h"
+#include "os/epoll.h"
+#include "os/process.h"
+#include "os/logging.h"
+#include "config.h"
+
+#include <unistd.h>
+
+EventPool *g_pool;
+
+extern "C" void* poolTrampoline(void *arg) {
+    osRenameThread(ABBREV_NAME "-pool");
+    static_cast<EventPool*>(arg)->workerMain();
+    return NULL;
+}
+
+EventPool::EventPool(unsigned nthreads) :
+    m_nthreads(nthreads)
+{
+    if ((m_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+        throw ErrnoException("epoll_create1", errno);
+    if (pthread_mutex_init(&m_lock, NULL) < 0)
+        throw ErrnoException("pthread_mutex_init", errno);
+    if (pthread_cond_init(&m_cond, NULL) < 0)
+        throw ErrnoException("pthread_cond_init", errno);
+
+    // Workers live as long as the process
+    for (unsigned i = 0; i < nthreads; ++i) {
+        pthread_t tid;
+        int rc = pthread_create(&tid, NULL, &poolTrampoline, this);
+        if (rc != 0)
+            throw ErrnoException("pthread_create", rc);
+        pthread_detach(tid);
+    }
+}
+
+static inline void
+pollAdd(int epfd, int fd, uint32_t events)
+{
+    epoll_event ev;
+    ev.events = events;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        throw ErrnoException("epoll_ctl", errno);
+}
+
+void
+EventPool::add(ThreadBase *obj)
+{
+    if ((obj->m_pollfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+        throw ErrnoException("epoll_create1", errno);
+    if ((obj->m_timerfd = osCreateTimer()) < 0)
+        throw ErrnoException("timerfd_create", errno);
+
+    pollAdd(obj->m_pollfd, obj->m_eventfd[0], EPOLLIN);
+    pollAdd(obj->m_pollfd, obj->m_timerfd, EPOLLIN);
+
+    obj->m_fds[1].fd = obj->m_fd;
+    obj->m_polled = -1;
+    obj->m_pooled = true;
+
+    // Fire right away so that a worker runs threadStarting
+    osSetTimer(obj->m_timerfd, 0);
+
+    epoll_event ev;
+    ev.events = EPOLLIN|EPOLLONESHOT;
+    ev.data.ptr = obj;
+
+    if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, obj->m_pollfd, &ev) < 0)
+        throw ErrnoException("epoll_ctl", errno);
+}
+
+void
+EventPool::join(ThreadBase *obj)
+{
+    pthread_mutex_lock(&m_lock);
+    while (!obj->m_poolDone)
+        pthread_cond_wait(&m_cond, &m_lock);
+    pthread_mutex_unlock(&m_lock);
+}
+
+/*
+ * Worker threads
+ */
+void
+EventPool::sync(ThreadBase *obj)
+{
+    // Follow changes made by setfd, closefd, and enablefd
+    const pollfd &pfd = obj->m_fds[1];
+
+    if (obj->m_polled != -1 && obj->m_polled != pfd.fd)
+        epoll_ctl(obj->m_pollfd, EPOLL_CTL_DEL, obj->m_polled, NULL);
+
+    if ((obj->m_polled = pfd.fd) != -1) {
+        epoll_event ev;
+        ev.events = (pfd.events & POLLIN) ? EPOLLIN : 0;
+        ev.data.fd = pfd.fd;
+
+        // The descriptor may have been closed and reopened under the same number
+        if (epoll_ctl(obj->m_pollfd, EPOLL_CTL_MOD, pfd.fd, &ev) < 0)
+            pollAdd(obj->m_pollfd, pfd.fd, ev.events);
+    }
+
+    osSetTimer(obj->m_timerfd, obj->m_timeout);
+}
+
+bool
+EventPool::dispatch(ThreadBase *obj)
+{
+    epoll_event evs[3];
+    bool haveFd = false, haveWork = false, haveTimer = false;
+    WorkItem item;
+
+    int n = epoll_wait(obj->m_pollfd, evs, 3, 0);
+
+    for (int i = 0; i < n; ++i)
+        if (evs[i].data.fd == obj->m_eventfd[0])
+            haveWork = true;
+        else if (evs[i].data.fd == obj->m_timerfd)
+            haveTimer = true;
+        else
+            haveFd = true;
+
+    if (haveTimer) {
+        uint64_t unused;
+        read(obj->m_timerfd, &unused, sizeof(unused));
+    }
+
+    if (!obj->m_poolStarted) {
+        obj->m_poolStarted = true;
+        obj->threadStarting();
+    }
+    else {
+        // Same order as runDescriptorLoop
+        obj->threadResumed();
+
+        if (haveFd && !obj->handleFd())
+            return false;
+        if (haveWork)
+            while (obj->nextWorkItem(item))
+                if (!obj->handleWork(item))
+                    return false;
+        if (!haveFd && !haveWork && haveTimer && !obj->handleIdle())
+            return false;
+    }
+
+    sync(obj);
+    return true;
+}
+
+void
+EventPool::finish(ThreadBase *obj, const std::exception *e)
+{
+    epoll_ctl(m_epfd, EPOLL_CTL_DEL, obj->m_pollfd, NULL);
+    close(obj->m_pollfd);
+    close(obj->m_timerfd);
+    obj->m_pollfd = obj->m_timerfd = -1;
+
+    obj->threadFinished(e);
+
+    // Object may be deleted once this is seen
+    pthread_mutex_lock(&m_lock);
+    obj->m_poolDone = true;
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_lock);
+}
+
+void
+EventPool::workerMain()
+{
+    epoll_event ev;
+
+    while (true) {
+        if (epoll_wait(m_epfd, &ev, 1, -1) < 1) {
+            if (errno != EINTR && errno != EAGAIN)
+                LOGERR("Pool: epoll_wait: %s\n", strerror(errno));
+            continue;
+        }
+
+        ThreadBase *obj = static_cast<ThreadBase*>(ev.data.ptr);
+        bool rc;
+
+        try {
+            rc = dispatch(obj);
+        }
+        catch (const std::exception &e) {
+            finish(obj, &e);
+            continue;
+        }
+
+        if (!rc) {
+            finish(obj, nullptr);
+            continue;
+        }
+
+        ev.events = EPOLLIN|EPOLLONESHOT;
+        ev.data.ptr = obj;
+        epoll_ctl(m_epfd, EPOLL_CTL_MOD, obj->m_pollfd, &ev);
+    }
+}
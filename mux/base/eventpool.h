@@ -0,0 +1,41 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <exception>
+#include <pthread.h>
+
+class ThreadBase;
+
+//
+// Shared epoll workers that run the descriptor loops of poolable objects
+// Each object has its own epoll set (event, fd, timer) registered here
+// one-shot, so that only one worker at a time dispatches it
+//
+class EventPool
+{
+private:
+    int m_epfd;
+    unsigned m_nthreads;
+
+    pthread_mutex_t m_lock;
+    pthread_cond_t m_cond;
+
+    bool dispatch(ThreadBase *obj);
+    void sync(ThreadBase *obj);
+    void finish(ThreadBase *obj, const std::exception *e);
+
+public:
+    EventPool(unsigned nthreads);
+
+    inline unsigned nthreads() const { return m_nthreads; }
+
+    void workerMain();
+
+    void add(ThreadBase *obj);
+    void join(ThreadBase *obj);
+};
+
+extern EventPool *g_pool;
@@ -14,6 +14,7 @@
 #include "lib/wire.h"
 #include "lib/machine.h"
 #include "lib/protocol.h"
+#include "lib/rowdiff.h"
 
 inline void
 TermEventFlags::setEventFlags()
@@ -44,16 +45,12 @@ ProxyEventState::ProxyEventState(TermProxy *proxy) :
 }
 
 static inline void
-combineRows(std::set<index_t> &dst, const std::set<index_t> &src,
-            index_t size, unsigned screenHeight)
+combineRows(RowSet &dst, const RowSet &src, index_t size, unsigned screenHeight)
 {
-    dst.insert(src.begin(), src.end());
+    dst.insert(src);
 
     // Note: possible bound multiplier would go here
-    size -= screenHeight;
-
-    for (auto i = dst.begin(); i != dst.end() && *i < size; i = dst.begin())
-        dst.erase(i);
+    dst.eraseBelow(size - screenHeight);
 }
 
 void
@@ -116,17 +113,13 @@ TermEventState::pullScreen()
     const TermBuffer *buffer = m_emulator->buffer(0);
     index_t end = buffer->size();
     index_t start = end - m_emulator->size().height();
-    for (index_t i = start; i < end; ++i) {
-        changedRows[0].emplace_hint(changedRows[0].end(), i);
-    }
+    changedRows[0].insert(start, end);
     buffer->pullRegions(start, end, changedRegions);
 
     buffer = m_emulator->buffer(1);
     end = buffer->size();
     start = end - m_emulator->size().height();
-    for (index_t i = start; i < end; ++i) {
-        changedRows[1].emplace_hint(changedRows[1].end(), i);
-    }
+    changedRows[1].insert(start, end);
     buffer->pullRegions(start, end, changedRegions);
 
     // Note: we're not responsible for setting rowsChanged/regionsChanged
@@ -158,6 +151,7 @@ TermEventTransfer::transferTermState(TermWatch *watch)
     auto &state = watch->state;
 
     TermEventFlags::operator=(state);
+    shadow = rowDiffs ? watch->shadow : nullptr;
 
     {
         // Copy
@@ -206,7 +200,7 @@ TermEventTransfer::transferTermState(TermWatch *watch)
             for (index_t i: state.changedRows[0]) {
                 if (i >= size)
                     break;
-                outRows[0].emplace_back(i, buffer->constRow(i));
+                outRows[0].emplace_back(i, buffer->snapshotRow(i));
             }
 
             // Buffer 1
@@ -214,7 +208,7 @@ TermEventTransfer::transferTermState(TermWatch *watch)
             for (index_t i: state.changedRows[1]) {
                 if (i >= size)
                     break;
-                outRows[1].emplace_back(i, buffer->constRow(i));
+                outRows[1].emplace_back(i, buffer->snapshotRow(i));
             }
         }
 
@@ -382,6 +376,107 @@ out:
     proxyData.clear();
 }
 
+inline void
+TermEventTransfer::writeRow(Tsq::ProtocolMachine *machine, index_t index,
+                            const CellRow &row, unsigned bufid)
+{
+    uint32_t rangeSize = row.m_ranges.size() * 4;
+    uint32_t strSize = row.m_str.size();
+    const uint32_t *ranges = row.m_ranges.data();
+
+    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    std::vector<uint32_t> swapped(row.m_ranges);
+    for (unsigned z = 0; z < swapped.size(); ++z)
+        swapped[z] = __builtin_bswap32(swapped[z]);
+    ranges = swapped.data();
+    #endif
+
+    buf[0] = htole32(TSQ_ROW_CONTENT);
+    buf[1] = htole32(36 + rangeSize + strSize);
+    buf[6] = htole32(index);
+    buf[7] = htole32(index >> 32);
+    buf[8] = htole32(row.flags|bufid);
+    buf[9] = htole32(row.modtime);
+    buf[10] = htole32(row.numRanges());
+    machine->connSend(reinterpret_cast<const char *>(buf), 44);
+    machine->connSend(reinterpret_cast<const char *>(ranges), rangeSize);
+    machine->connSend(row.m_str.data(), strSize);
+}
+
+inline bool
+TermEventTransfer::writeRowDiff(Tsq::ProtocolMachine *machine, index_t index,
+                                const CellRow &prev, const CellRow &row, unsigned bufid)
+{
+    const auto &r = row.m_ranges;
+    const auto &s = row.m_str;
+    Tsq::RowDiff diff;
+    Tsq::diffRows(prev.m_ranges, prev.m_str, r, s, diff);
+
+    uint32_t rangeSize = diff.radd * 24;
+    uint32_t strSize = diff.sadd;
+
+    // Not worth it unless smaller than the full row
+    if (56 + rangeSize + strSize >= 36 + r.size() * 4 + s.size())
+        return false;
+
+    const uint32_t *ranges = r.data() + diff.rstart * 6;
+
+    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    std::vector<uint32_t> swapped(ranges, ranges + rangeSize / 4);
+    for (unsigned z = 0; z < swapped.size(); ++z)
+        swapped[z] = __builtin_bswap32(swapped[z]);
+    ranges = swapped.data();
+    #endif
+
+    buf[0] = htole32(TSQ_ROW_DIFF);
+    buf[1] = htole32(56 + rangeSize + strSize);
+    buf[6] = htole32(index);
+    buf[7] = htole32(index >> 32);
+    buf[8] = htole32(row.flags|bufid);
+    buf[9] = htole32(row.modtime);
+    buf[10] = htole32(Tsq::rowChecksum(prev.m_ranges, prev.m_str));
+    buf[11] = htole32(diff.radd);
+    buf[12] = htole32(diff.rstart);
+    buf[13] = htole32(diff.rremove);
+    buf[14] = htole32(diff.sstart);
+    buf[15] = htole32(diff.sremove);
+    machine->connSend(reinterpret_cast<const char *>(buf), 64);
+    machine->connSend(reinterpret_cast<const char *>(ranges), rangeSize);
+    machine->connSend(s.data() + diff.sstart, strSize);
+    return true;
+}
+
+void
+TermEventTransfer::writeRows(Tsq::ProtocolMachine *machine, unsigned bufid)
+{
+    for (auto &&i: outRows[bufid])
+    {
+        if (!shadow) {
+            writeRow(machine, i.first, *i.second, bufid);
+            continue;
+        }
+
+        // Send a diff against the last version sent, then remember this one
+        auto &rows = shadow[bufid];
+        auto k = rows.find(i.first);
+        if (k == rows.end()) {
+            writeRow(machine, i.first, *i.second, bufid);
+            rows.emplace(i.first, std::move(i.second));
+
+            if (rows.size() > MAX_SHADOW_ROWS)
+                rows.erase(rows.begin());
+        } else {
+            if (k->second == i.second)
+                continue;
+            if (!writeRowDiff(machine, i.first, *k->second, *i.second, bufid))
+                writeRow(machine, i.first, *i.second, bufid);
+            k->second = std::move(i.second);
+        }
+    }
+
+    outRows[bufid].clear();
+}
+
 void
 TermEventTransfer::writeTermResponses(TermReader *reader)
 {
@@ -407,6 +502,8 @@ TermEventTransfer::writeTermResponses(TermReader *reader)
     }
 
     if (bufferChanged[0][1]) {
+        if (shadow)
+            shadow[0].clear();
         buf[0] = htole32(TSQ_BUFFER_CAPACITY);
         buf[1] = htole32(28);
         buf[6] = htole32(bufSize[0]);
@@ -424,6 +521,8 @@ TermEventTransfer::writeTermResponses(TermReader *reader)
     }
 
     if (bufferChanged[1][1]) {
+        if (shadow)
+            shadow[1].clear();
         buf[0] = htole32(TSQ_BUFFER_CAPACITY);
         buf[1] = htole32(28);
         buf[6] = htole32(bufSize[1]);
@@ -508,53 +607,8 @@ TermEventTransfer::writeTermResponses(TermReader *reader)
     }
 
     if (rowsChanged) {
-        buf[0] = htole32(TSQ_ROW_CONTENT);
-        for (auto &&i: outRows[0])
-        {
-            CellRow &row = i.second;
-            uint32_t rangeSize = row.m_ranges.size() * 4;
-            uint32_t strSize = row.m_str.size();
-
-            #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-            for (unsigned z = 0; z < row.m_ranges.size(); ++z)
-                row.m_ranges[z] = __builtin_bswap32(row.m_ranges[z]);
-            #endif
-
-            buf[1] = htole32(36 + rangeSize + strSize);
-            buf[6] = htole32(i.first);
-            buf[7] = htole32(i.first >> 32);
-            buf[8] = htole32(row.flags);
-            buf[9] = htole32(row.modtime);
-            buf[10] = htole32(row.numRanges());
-            machine->connSend(reinterpret_cast<const char *>(buf), 44);
-            machine->connSend(reinterpret_cast<const char *>(row.m_ranges.data()), rangeSize);
-            machine->connSend(row.m_str.data(), strSize);
-        }
-
-        for (auto &&i: outRows[1])
-        {
-            CellRow &row = i.second;
-            uint32_t rangeSize = row.m_ranges.size() * 4;
-            uint32_t strSize = row.m_str.size();
-
-            #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-            for (unsigned z = 0; z < row.m_ranges.size(); ++z)
-                row.m_ranges[z] = __builtin_bswap32(row.m_ranges[z]);
-            #endif
-
-            buf[1] = htole32(36 + rangeSize + strSize);
-            buf[6] = htole32(i.first);
-            buf[7] = htole32(i.first >> 32);
-            buf[8] = htole32(row.flags|1);
-            buf[9] = htole32(row.modtime);
-            buf[10] = htole32(row.numRanges());
-            machine->connSend(reinterpret_cast<const char *>(buf), 44);
-            machine->connSend(reinterpret_cast<const char *>(row.m_ranges.data()), rangeSize);
-            machine->connSend(row.m_str.data(), strSize);
-        }
-
-        outRows[0].clear();
-        outRows[1].clear();
+        writeRows(machine, 0);
+        writeRows(machine, 1);
     }
 
     if (!files.empty()) {
@@ -8,6 +8,7 @@
 #include "cursor.h"
 #include "attributemap.h"
 #include "region.h"
+#include "rowset.h"
 
 #include <set>
 #include <map>
@@ -22,6 +23,12 @@ class TermWatch;
 class TermProxyWatch;
 
 #define MAX_QUEUED_REGIONS 512
+#define MAX_SHADOW_ROWS 256
+
+namespace Tsq { class ProtocolMachine; }
+
+// Rows last sent to a client, used as the base of row diffs
+typedef std::map<index_t,RowSnapshot> RowShadow;
 
 struct TermEventFlags
 {
@@ -40,7 +47,7 @@ struct TermEventFlags
 
 struct TermEventBase: TermEventFlags
 {
-    std::set<index_t> changedRows[2];
+    RowSet changedRows[2];
     std::set<bufreg_t> changedRegions;
 
     inline TermEventBase(): TermEventFlags{} {}
@@ -109,7 +116,7 @@ struct TermEventTransfer: TermEventFlags
     CursorBase cursor;
     Point mousePos;
 
-    std::vector<std::pair<index_t,CellRow>> outRows[2];
+    std::vector<std::pair<index_t,RowSnapshot>> outRows[2];
     std::vector<Region> outRegions;
 
     StringMap attributes;
@@ -117,6 +124,15 @@ struct TermEventTransfer: TermEventFlags
 
     std::vector<std::pair<uint32_t,std::string>> proxyData;
 
+    bool rowDiffs = false;
+    RowShadow *shadow;
+
+    void writeRow(Tsq::ProtocolMachine *machine, index_t index,
+                  const CellRow &row, unsigned bufid);
+    bool writeRowDiff(Tsq::ProtocolMachine *machine, index_t index,
+                      const CellRow &prev, const CellRow &row, unsigned bufid);
+    void writeRows(Tsq::ProtocolMachine *machine, unsigned bufid);
+
     void transferBaseState(BaseWatch *watch);
     void transferTermState(TermWatch *watch);
     void transferProxyState(TermProxyWatch *watch);
@@ -19,8 +19,10 @@
 #include "lib/attrstr.h"
 #include "config.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #define PATHSIZE 1024
 
@@ -51,6 +53,24 @@ TermFilemon::setLimit(const std::string &value)
         sendWork(FilemonRelimit, num);
 }
 
+void
+TermFilemon::setPage(const std::string &value)
+{
+    // Value is the offset of the page followed by its directory
+    const char *startptr = value.c_str();
+    char *endptr;
+    unsigned num = strtoul(startptr, &endptr, 10);
+
+    if (*startptr && *endptr == ':') {
+        {
+            Lock lock(this);
+            m_nextPageOffset = num;
+            m_nextPagePath.assign(endptr + 1);
+        }
+        sendWork(FilemonRepage, 0);
+    }
+}
+
 void
 TermFilemon::monitor(const std::string &directory)
 {
@@ -69,9 +89,17 @@ TermFilemon::monitor(const std::string &directory)
 bool
 TermFilemon::handleGitEvent(const struct inotify_event *e)
 {
-    if ((m_gitWd == e->wd && e->len &&
-         (!strcmp(e->name, "index") || !strcmp(e->name, "HEAD") ||
-          !strcmp(e->name, "FETCH_HEAD") || !strcmp(e->name, "config"))) ||
+    if (m_gitWd == e->wd && e->len &&
+        (!strcmp(e->name, "index") || !strcmp(e->name, "HEAD") ||
+         !strcmp(e->name, "FETCH_HEAD")))
+    {
+        // start over, keeping the status if index and HEAD are unchanged
+        // LOGDBG("Filemon %p: starting over (git, %s)\n", this, e->name);
+        m_gitKeep = true;
+        monitor(m_path);
+        return false;
+    }
+    if ((m_gitWd == e->wd && e->len && !strcmp(e->name, "config")) ||
         m_gitWatches.count(e->wd))
     {
         // start over
@@ -279,20 +307,120 @@ TermFilemon::openGit(Tsq::ProtocolMarshaler *m)
             setGitWatches();
 
         describeGit(m);
+        loadGitStatus();
     }
 }
 
+void
+TermFilemon::loadGitStatus()
+{
+    // Key the status on the index mtime and HEAD commit
+    // The repository path also covers worktrees and submodules
+    std::string index = git_repository_path(m_git);
+    index.append("index");
+    struct stat st;
+    int64_t indexTime = 0;
+    git_oid oid;
+    std::string head;
+
+    if (stat(index.c_str(), &st) == 0)
+        indexTime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    if (git_reference_name_to_id(&oid, m_git, "HEAD") == 0)
+        head.assign((const char *)oid.id, sizeof(oid.id));
+
+    if (m_gitstatus.valid && m_gitstatus.rel == m_gitrel &&
+        m_gitstatus.indexTime == indexTime && m_gitstatus.head == head)
+        return;
+
+    m_gitstatus.valid = false;
+    m_gitstatus.rel = m_gitrel;
+    m_gitstatus.head = std::move(head);
+    m_gitstatus.indexTime = indexTime;
+    m_gitstatus.fallback = GIT_STATUS_CURRENT;
+    m_gitstatus.files.clear();
+
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+    git_status_list *list;
+    std::string prefix = m_gitrel;
+    char *pathspec;
+
+    opts.show = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+    opts.flags = GIT_STATUS_OPT_INCLUDE_UNTRACKED|GIT_STATUS_OPT_INCLUDE_IGNORED|
+        GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+
+    // Everything under the monitored directory, without descending into
+    // untracked or ignored directories
+    if (!prefix.empty()) {
+        if (prefix.back() == '/')
+            prefix.pop_back();
+        pathspec = &prefix[0];
+        opts.pathspec.strings = &pathspec;
+        opts.pathspec.count = 1;
+    }
+
+    if (git_status_list_new(&list, m_git, &opts) != 0)
+        return;
+
+    size_t n = git_status_list_entrycount(list);
+    size_t len = m_gitrel.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        const git_status_entry *entry = git_status_byindex(list, i);
+        const git_diff_delta *delta = entry->index_to_workdir ?
+            entry->index_to_workdir : entry->head_to_index;
+        if (!delta || !delta->new_file.path)
+            continue;
+
+        const char *path = delta->new_file.path;
+        size_t plen = strlen(path);
+
+        if (plen <= len) {
+            // An untracked or ignored directory containing this one
+            if (plen && path[plen - 1] == '/' && !m_gitrel.compare(0, plen, path))
+                m_gitstatus.fallback = entry->status;
+        }
+        else if (!m_gitrel.compare(0, len, path, len)) {
+            // Untracked or ignored directories at this level end in '/'
+            const char *slash = strchr(path + len, '/');
+            if (!slash)
+                m_gitstatus.files.emplace(path + len, entry->status);
+            else if (!slash[1])
+                m_gitstatus.files.emplace(std::string(path + len, slash), entry->status);
+        }
+    }
+
+    git_status_list_free(list);
+    m_gitstatus.valid = true;
+}
+
+void
+TermFilemon::refreshGit(const std::string &name)
+{
+    unsigned flags;
+    std::string tmp = m_gitrel + name;
+
+    if (m_gitstatus.valid && git_status_file(&flags, m_git, tmp.c_str()) == 0)
+        m_gitstatus.files[name] = flags;
+}
+
 inline void
 TermFilemon::checkGit(const std::string &name, Tsq::ProtocolMarshaler *m)
 {
+    // Only called for files and links, directories carry no status
     unsigned flags;
-    std::string tmp = m_gitrel + name;
 
-    if (git_status_file(&flags, m_git, tmp.c_str()) == 0) {
-        char buf[16];
-        snprintf(buf, sizeof(buf), "%x", flags);
-        m->addStringPair(TSQ_ATTR_FILE_GIT, buf);
+    if (m_gitstatus.valid) {
+        auto i = m_gitstatus.files.find(name);
+        flags = (i != m_gitstatus.files.end()) ? i->second : m_gitstatus.fallback;
+    } else {
+        std::string tmp = m_gitrel + name;
+        if (git_status_file(&flags, m_git, tmp.c_str()) != 0)
+            return;
     }
+
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%x", flags);
+    m->addStringPair(TSQ_ATTR_FILE_GIT, buf);
 }
 #endif // USE_LIBGIT2
 
@@ -329,16 +457,6 @@ TermFilemon::reportDirectoryUpdate(const std::string &msg)
     m_parent->reportDirectoryUpdate(msg);
 }
 
-void
-TermFilemon::reportDirectoryOverlimit()
-{
-    Tsq::ProtocolMarshaler m(TSQ_DIRECTORY_UPDATE, 16, m_id.buf);
-    m.addNumber64(osWalltime());
-    m.addString(m_path);
-    m.addStringPair(Tsq::attr_FILE_OVERLIMIT, std::to_string(m_limit));
-    reportDirectoryUpdate(m.result());
-}
-
 inline void
 TermFilemon::reportFileRemoved(const std::string &name, const std::string &msg)
 {
@@ -360,8 +478,9 @@ TermFilemon::reportFileUpdate(const std::string &name, std::string &&msg)
             // Don't report duplicate events
             return true;
         }
-    } else if (++m_nfiles > m_limit) {
-        reportDirectoryOverlimit();
+    } else if (++m_nfiles > m_limit && !m_paged) {
+        // start over, showing the directory in pages
+        monitor(m_path);
         return false;
     }
     {
@@ -406,6 +525,13 @@ TermFilemon::buildMsg(const std::string &name, const FileInfo *info, bool git)
     return m.result();
 }
 
+inline bool
+TermFilemon::onPage(const std::string &name) const
+{
+    return (m_pageFirst.empty() || name >= m_pageFirst) &&
+        (m_pageLast.empty() || name <= m_pageLast);
+}
+
 bool
 TermFilemon::handleNotifyEvent(const struct inotify_event *e)
 {
@@ -423,6 +549,10 @@ TermFilemon::handleNotifyEvent(const struct inotify_event *e)
 
     std::string name(e->name);
 
+    // Changes outside of the page being shown are not reported
+    if (!onPage(name))
+        return true;
+
     if (e->mask & (IN_DELETE|IN_MOVED_FROM)) {
         if (m_attributes.count(name)) {
             Tsq::ProtocolMarshaler m(TSQ_FILE_REMOVED, 16, m_id.buf);
@@ -435,6 +565,9 @@ TermFilemon::handleNotifyEvent(const struct inotify_event *e)
         FileInfo info(m_dirFd);
         int rc = osStatFile(e->name, &info);
         if (rc != -1) {
+            if (USE_LIBGIT2 && m_git && rc == 1)
+                refreshGit(name);
+
             std::string msg = buildMsg(name, &info, rc == 1);
             return reportFileUpdate(name, std::move(msg));
         }
@@ -491,24 +624,22 @@ TermFilemon::handleDirFd()
 
     for (int i = 0; i < FILEMON_BATCH_SIZE; ++i)
     {
-        switch (rc = osReadDir(m_dir, &info)) {
-        default:
-            if (++m_nfiles > m_limit) {
-                closefd();
-                reportDirectoryOverlimit();
-                return;
-            }
-            msg = buildMsg(info.name, &info, rc == 2);
-            map.emplace(std::move(info.name), std::move(msg));
-            info.fattr.clear();
-            // fallthru
-        case 0:
-            continue;
-        case -1:
+        if (m_listPos == m_listEnd) {
             // LOGDBG("Filemon %p: reading finished\n", this);
+            std::string().swap(m_listing);
+            std::vector<unsigned>().swap(m_sorted);
             setfd(m_notifyFd);
+            break;
+        }
+
+        const char *name = m_listing.data() + m_sorted[m_listPos++];
+
+        if ((rc = osStatFile(name, &info)) != -1) {
+            ++m_nfiles;
+            msg = buildMsg(name, &info, rc == 1);
+            map.emplace(name, std::move(msg));
+            info.fattr.clear();
         }
-        break;
     }
 
     if (!map.empty()) {
@@ -523,6 +654,46 @@ TermFilemon::handleDirFd()
     }
 }
 
+bool
+TermFilemon::setupPage(Tsq::ProtocolMarshaler *m)
+{
+    const char *base = m_listing.data();
+
+    for (size_t pos = 0; pos < m_listing.size(); pos += strlen(base + pos) + 1)
+        m_sorted.push_back(pos);
+
+    m_listPos = 0;
+    m_listEnd = m_sorted.size();
+
+    if (!(m_paged = m_listEnd > m_limit))
+        return true;
+    if (m_limit == 0) {
+        m->addStringPair(Tsq::attr_FILE_OVERLIMIT, std::to_string(m_limit));
+        return false;
+    }
+
+    std::sort(m_sorted.begin(), m_sorted.end(), [base](unsigned a, unsigned b) {
+        return strcmp(base + a, base + b) < 0;
+    });
+
+    // Round the requested offset down to the start of a page
+    size_t offset = (m_path == m_pagePath) ? m_pageOffset : 0;
+    offset = std::min(offset, m_listEnd - 1) / m_limit * m_limit;
+
+    if (offset)
+        m_pageFirst = base + m_sorted[offset];
+    if (offset + m_limit < m_listEnd) {
+        m_listEnd = offset + m_limit;
+        m_pageLast = base + m_sorted[m_listEnd - 1];
+    }
+
+    m->addStringPair(Tsq::attr_FILE_OFFSET, std::to_string(offset));
+    m->addStringPair(Tsq::attr_FILE_TOTAL, std::to_string(m_sorted.size()));
+    m->addStringPair(Tsq::attr_FILE_LIMIT, std::to_string(m_limit));
+    m_listPos = offset;
+    return true;
+}
+
 bool
 TermFilemon::handleFd()
 {
@@ -544,8 +715,17 @@ TermFilemon::handleDirectory(std::string *dir)
 
     closefd();
     m_nfiles = 0;
+    m_paged = false;
+    m_pageFirst.clear();
+    m_pageLast.clear();
     m_users.clear();
     m_groups.clear();
+#if USE_LIBGIT2
+    // Changes made while not monitoring would be missed
+    if (!m_gitKeep || m_path != *dir)
+        m_gitstatus.valid = false;
+    m_gitKeep = false;
+#endif
     m_path = std::move(*dir);
     delete dir;
 
@@ -567,12 +747,30 @@ TermFilemon::handleDirectory(std::string *dir)
         m.addStringPair(TSQ_ATTR_FILE_ERROR, strerror(errno));
         goto out;
     }
+
+    // Watch before listing, so files created meanwhile are not missed
     if ((m_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) != -1) {
         m_notifyWd = inotify_add_watch(m_notifyFd, path,
             IN_ATTRIB|IN_MODIFY|IN_CREATE|IN_DELETE|IN_MOVE|
             IN_DELETE_SELF|IN_MOVE_SELF|IN_EXCL_UNLINK|IN_ONLYDIR);
     }
 
+    // Read all names up front, so large directories can be sorted
+    // and only the requested page of entries examined
+    m_listing.clear();
+    m_sorted.clear();
+    if (osListDir(m_dir, m_listing) < 0) {
+        m.addStringPair(TSQ_ATTR_FILE_ERROR, strerror(errno));
+        closefd();
+        goto out;
+    }
+    if (!setupPage(&m)) {
+        std::string().swap(m_listing);
+        std::vector<unsigned>().swap(m_sorted);
+        closefd();
+        goto out;
+    }
+
     if (USE_LIBGIT2 && g_args->git())
         openGit(&m);
 
@@ -591,6 +789,22 @@ TermFilemon::handleRelimit(unsigned limit)
     handleDirectory(new std::string(m_path));
 }
 
+void
+TermFilemon::handleRepage()
+{
+    {
+        Lock lock(this);
+        m_pagePath = m_nextPagePath;
+        m_pageOffset = m_nextPageOffset;
+    }
+
+    // start over if the page is in the directory being shown
+    if (m_paged && m_pagePath == m_path) {
+        // LOGDBG("Filemon %p: starting over (repage)\n", this);
+        handleDirectory(new std::string(m_path));
+    }
+}
+
 bool TermFilemon::handleWork(const WorkItem &item)
 {
     switch (item.type) {
@@ -602,6 +816,9 @@ bool TermFilemon::handleWork(const WorkItem &item)
     case FilemonRelimit:
         handleRelimit((unsigned)item.value);
         break;
+    case FilemonRepage:
+        handleRepage();
+        break;
     default:
         break;
     }
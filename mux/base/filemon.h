@@ -8,6 +8,7 @@
 
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 #include <memory>
 #include <dirent.h>
 
@@ -32,6 +33,17 @@ private:
     unsigned m_limit;
 
     std::string m_path;
+    // NUL-separated names, and their offsets in name order
+    std::string m_listing;
+    std::vector<unsigned> m_sorted;
+    size_t m_listPos = 0, m_listEnd = 0;
+
+    // Large directories are shown one page of m_limit names at a time
+    // The page is bounded by its first and last names, empty if unbounded
+    bool m_paged = false;
+    std::string m_pageFirst, m_pageLast;
+    std::string m_pagePath, m_nextPagePath;
+    unsigned m_pageOffset = 0, m_nextPageOffset = 0;
     std::unordered_map<uint32_t,std::string> m_users, m_groups;
     std::unordered_set<std::string*> m_incomingDirectories;
 
@@ -59,6 +71,19 @@ private:
     std::unordered_map<std::string,GitCache> m_gitcache;
     std::unordered_map<std::string,std::weak_ptr<GitRepo>> m_gitrepos;
     std::unordered_set<int> m_gitWatches;
+
+    // Status of the monitored directory, from one status list
+    struct GitStatus {
+        std::string rel;
+        std::string head;
+        int64_t indexTime;
+        unsigned fallback;
+        bool valid = false;
+        std::unordered_map<std::string,unsigned> files;
+    };
+
+    GitStatus m_gitstatus;
+    bool m_gitKeep = false;
 #endif
 
 private:
@@ -66,6 +91,8 @@ private:
     void openGit(Tsq::ProtocolMarshaler *m);
     void findGit(int64_t now);
     void setGitWatches();
+    void loadGitStatus();
+    void refreshGit(const std::string &name);
     void checkGit(const std::string &name, Tsq::ProtocolMarshaler *m);
     bool handleGitEvent(const struct inotify_event *e);
 
@@ -74,19 +101,21 @@ private:
     std::string buildMsg(const std::string &name, const FileInfo *info, bool git);
 
     void reportDirectoryUpdate(const std::string &msg);
-    void reportDirectoryOverlimit();
     void reportFileRemoved(const std::string &name, const std::string &msg);
     bool reportFileUpdate(const std::string &name, std::string &&msg);
 
     bool handleNotifyEvent(const struct inotify_event *e);
     void handleNotifyFd();
     void handleDirFd();
+    bool setupPage(Tsq::ProtocolMarshaler *m);
+    bool onPage(const std::string &name) const;
 
     void threadMain();
     bool handleFd();
     bool handleWork(const WorkItem &item);
     void handleDirectory(std::string *dir);
     void handleRelimit(unsigned limit);
+    void handleRepage();
 
 public:
     TermFilemon(unsigned limit, TermInstance *parent);
@@ -97,10 +126,12 @@ public:
 
     void monitor(const std::string &directory);
     void setLimit(const std::string &value);
+    void setPage(const std::string &value);
 };
 
 enum FilemonWork {
     FilemonClose,
     FilemonDirectory,
     FilemonRelimit,
+    FilemonRepage,
 };
@@ -6,6 +6,7 @@
 #include "portfwdtask.h"
 #include "listener.h"
 #include "os/logging.h"
+#include "os/time.h"
 #include "lib/wire.h"
 #include "lib/protocol.h"
 
@@ -22,6 +23,7 @@ PortBase::PortBase(const char *name, Tsq::ProtocolUnmarshaler *unm, unsigned fla
 {
     m_chunkSize = unm->parseNumber();
     m_windowSize = unm->parseNumber();
+    m_window = new TaskWindow(m_chunkSize, m_windowSize);
 
     switch (unm->parseNumber()) {
     case Tsq::PortForwardTCP:
@@ -49,6 +51,10 @@ PortBase::PortBase(const char *name, Tsq::ProtocolUnmarshaler *unm, unsigned fla
 
 PortBase::~PortBase()
 {
+    LOGDBG("PortFwd %p: sent %zu bytes (%" PRIu64 " B/s, window %zu, rtt %" PRId64 "ms)\n",
+           this, m_sent, m_window->rate(), m_window->window(), m_window->rtt());
+
+    delete m_window;
     delete [] m_buf;
 }
 
@@ -89,6 +95,7 @@ PortBase::pushBytes(portfwd_t id, size_t len)
 
     std::string buf(m_buf, HEADERSIZE + len);
     m_sent += len;
+    m_window->sent(m_sent, m_acked, osMonotime());
 
     if (!throttledOutput(buf)) {
         LOGDBG("PortFwd %p: throttled (local)\n", this);
@@ -220,6 +227,7 @@ PortBase::handleData(std::string *data)
         break;
     case Tsq::TaskAcking:
         m_acked = unm.parseNumber64();
+        m_window->acked(m_acked, osMonotime());
 
         if (!m_running) {
             m_running = true;
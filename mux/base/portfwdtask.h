@@ -6,6 +6,7 @@
 
 #include "lib/types.h"
 #include "taskbase.h"
+#include "taskwindow.h"
 
 #include <unordered_map>
 
@@ -25,6 +26,7 @@ protected:
 
     size_t m_received = 0, m_chunks = 0; // from client
     size_t m_sent = 0, m_acked = 0; // to client
+    TaskWindow *m_window;
 
     std::unordered_map<int,PortFwdState*> m_fdmap;
     std::unordered_map<portfwd_t,PortFwdState*> m_idmap;
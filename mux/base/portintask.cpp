@@ -178,7 +178,7 @@ PortIn::handleMultiFd(pollfd &pfd)
 
     if (pfd.revents & POLLOUT)
         writefd(pfd, cstate);
-    else if (m_sent - m_acked >= m_windowSize * m_chunkSize)
+    else if (!m_window->open(m_sent, m_acked))
         watchReads(m_running = false);
     else if (cstate->special)
         acceptfd(pfd, cstate);
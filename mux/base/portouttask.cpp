@@ -185,7 +185,7 @@ PortOut::handleMultiFd(pollfd &pfd)
         connectfd(pfd, cstate);
     else if (pfd.revents & POLLOUT)
         writefd(pfd, cstate);
-    else if (m_sent - m_acked >= m_windowSize * m_chunkSize)
+    else if (!m_window->open(m_sent, m_acked))
         watchReads(m_running = false);
     else
         readfd(pfd, cstate);
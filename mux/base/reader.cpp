@@ -13,15 +13,18 @@
 #include "exception.h"
 #include "os/conn.h"
 #include "os/logging.h"
+#include "os/time.h"
+#include "lib/attr.h"
 #include "lib/protocol.h"
 #include "lib/wire.h"
 #include "lib/sequences.h"
 #include "config.h"
 
+#include <cinttypes>
 #include <unistd.h>
 
 TermReader::TermReader(int writeFd, StringMap &&environ) :
-    ThreadBase("reader", ThreadBaseFd),
+    ThreadBase("reader", ThreadBaseFd|ThreadBasePoolable),
     m_writer(new TermWriter(this)),
     m_machine(new ServerMachine(this)),
     m_writeFd(writeFd),
@@ -89,14 +92,47 @@ TermReader::closefd()
 bool
 TermReader::handleFd()
 {
-    if (m_machine->connRead(m_fd))
+    if (m_machine->connRead(m_fd)) {
+        publishStats(false);
         return true;
-    else {
+    } else {
         m_cleanExit = true;
         return false;
     }
 }
 
+void
+TermReader::publishStats(bool final)
+{
+    const Tsq::ProtocolStats *stats = m_machine->stats();
+    if (!stats)
+        return;
+
+    int64_t now = osMonotime();
+    if (!final && now - m_statsTime < COMPRESS_STATS_INTERVAL)
+        return;
+
+    m_statsTime = now;
+
+    // Bytes out (raw, wire), bytes in (wire, raw), then codec CPU ms
+    char buf[160];
+    snprintf(buf, sizeof(buf), "%" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64
+             " %" PRIu64 " %" PRIu64,
+             (uint64_t)stats->rawOut, (uint64_t)stats->wireOut,
+             (uint64_t)stats->wireIn, (uint64_t)stats->rawIn,
+             (uint64_t)stats->deflateTime / 1000000,
+             (uint64_t)stats->inflateTime / 1000000);
+
+    std::string key = TSQ_ATTR_COMPRESS_PREFIX + m_remoteId.str();
+
+    if (!final) {
+        g_listener->commandSetAttribute(key, buf);
+    } else {
+        LOGDBG("Reader %p: compression %s\n", this, buf);
+        g_listener->commandRemoveAttribute(key);
+    }
+}
+
 void
 TermReader::handleWatchAdded(BaseWatch *watch)
 {
@@ -151,6 +187,8 @@ TermReader::handleWork(const WorkItem &item)
 bool
 TermReader::handleIdle()
 {
+    publishStats(false);
+
     if (m_idleOut) {
         LOGDBG("Reader %p: keepalive timed out\n", this);
         m_exitStatus = TSQ_STATUS_IDLE_TIMEOUT;
@@ -166,17 +204,19 @@ TermReader::handleIdle()
 }
 
 void
-TermReader::threadMain()
+TermReader::threadStarting()
 {
-    try {
-        m_machine->start();
-        runDescriptorLoop();
-    }
-    catch (const TsqException &e) {
-        LOGWRN("Reader %p: %s\n", this, e.what());
-        m_exitStatus = e.status();
-    } catch (const std::exception &e) {
-        LOGERR("Reader %p: caught exception: %s\n", this, e.what());
+    m_machine->start();
+}
+
+void
+TermReader::threadFinished(const std::exception *e)
+{
+    if (auto *te = dynamic_cast<const TsqException*>(e)) {
+        LOGWRN("Reader %p: %s\n", this, te->what());
+        m_exitStatus = te->status();
+    } else if (e) {
+        LOGERR("Reader %p: caught exception: %s\n", this, e->what());
         m_exitStatus = TSQ_STATUS_SERVER_ERROR;
     }
 
@@ -199,12 +239,20 @@ TermReader::threadMain()
         write(m_savedWriteFd, &c, 1);
     }
 
+    publishStats(true);
+
     LOGDBG("Reader %p: goodbye\n", this);
     closefd();
 
     g_listener->sendWork(ListenerRemoveReader, this);
 }
 
+void
+TermReader::threadMain()
+{
+    runPoolableLoop();
+}
+
 /*
  * State machine
  */
@@ -214,6 +262,12 @@ TermReader::writeFd(const char *buf, size_t len)
     m_writer->writeFd(m_writeFd, buf, len);
 }
 
+void
+TermReader::writevFd(struct iovec *iov, int iovcnt)
+{
+    m_writer->writevFd(m_writeFd, iov, iovcnt);
+}
+
 bool
 TermReader::setMachine(Tsq::ProtocolMachine *newMachine, char protocolType)
 {
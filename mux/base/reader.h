@@ -36,6 +36,7 @@ private:
     int m_savedWriteFd = -1;
     bool m_idleOut = false;
     bool m_cleanExit = false;
+    int64_t m_statsTime = 0;
 
     Tsq::Uuid m_remoteId;
     std::unordered_set<Tsq::Uuid> m_knownClients, m_ignoredClients;
@@ -43,9 +44,12 @@ private:
 
 private:
     void threadMain();
+    void threadStarting();
+    void threadFinished(const std::exception *e);
     bool handleIdle();
     bool handleFd();
     void closefd();
+    void publishStats(bool final);
 
     bool setMachine(Tsq::ProtocolMachine *newMachine, char protocolType);
     void setFd(int newrd, int newwd);
@@ -96,6 +100,7 @@ private:
     void commandTermSendSignal(ConnWatch *watch, const char *body, uint32_t length);
     void commandTermGetRows(ConnWatch *watch, const char *body, uint32_t length);
     void commandTermGetImage(ConnWatch *watch, const char *body, uint32_t length);
+    void commandTermSearchRows(ConnWatch *watch, const char *body, uint32_t length);
     void commandTermDownloadImage(ConnWatch *watch, const char *body, uint32_t length);
     void commandTermChangeOwner(ConnWatch *watch, const char *body);
 
@@ -118,6 +123,7 @@ public:
 
     bool protocolCallback(uint32_t command, uint32_t length, const char *body);
     void writeFd(const char *buf, size_t len);
+    void writevFd(struct iovec *iov, int iovcnt);
 
     static void pushTaskResume(const Tsq::Uuid &id);
 };
@@ -25,7 +25,7 @@ RegionStringBuilder::RegionStringBuilder(const Region *region, const TermBuffer
         return;
     }
 
-    const CellRow &row = m_buffer->constRow(m_cur);
+    CellRow row = m_buffer->copyRow(m_cur);
 
     if (m_cur == m_end) {
         m_result.append(row.substr(region->startCol, region->endCol, m_lookup));
@@ -42,7 +42,7 @@ RegionStringBuilder::build()
     if (!m_done)
         while (++m_cur < m_size)
         {
-            const CellRow &row = m_buffer->constRow(m_cur);
+            CellRow row = m_buffer->copyRow(m_cur);
 
             if (!(row.flags & Tsq::Continuation)) {
                 if (--m_maxLines == 0)
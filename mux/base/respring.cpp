@@ -0,0 +1,67 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "respring.h"
+
+ResponseRing::ResponseRing(size_t size) :
+    m_slots(new Slot[size]),
+    m_mask(size - 1)
+{
+    for (size_t i = 0; i < size; ++i)
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+}
+
+ResponseRing::~ResponseRing()
+{
+    delete [] m_slots;
+}
+
+bool
+ResponseRing::push(std::string &buf)
+{
+    Slot *slot;
+    size_t pos = m_head.load(std::memory_order_relaxed);
+
+    while (1) {
+        slot = m_slots + (pos & m_mask);
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            return false;
+        }
+        else {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->data = std::move(buf);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+std::string *
+ResponseRing::front()
+{
+    Slot *slot = m_slots + (m_tail & m_mask);
+    size_t seq = slot->seq.load(std::memory_order_acquire);
+
+    return (seq == m_tail + 1) ? &slot->data : nullptr;
+}
+
+void
+ResponseRing::pop()
+{
+    Slot *slot = m_slots + (m_tail & m_mask);
+
+    // Release the spent buffer rather than pinning it until the next lap
+    std::string().swap(slot->data);
+    slot->seq.store(m_tail + m_mask + 1, std::memory_order_release);
+    ++m_tail;
+}
@@ -0,0 +1,38 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+//
+// Bounded lock-free queue of responses, many producers and one consumer
+// Each slot carries a sequence number marking it free or filled for a lap
+//
+class ResponseRing
+{
+private:
+    struct Slot {
+        std::atomic_size_t seq;
+        std::string data;
+    };
+
+    Slot *m_slots;
+    const size_t m_mask;
+
+    alignas(64) std::atomic_size_t m_head{0};
+    alignas(64) size_t m_tail = 0;
+
+public:
+    ResponseRing(size_t size);
+    ~ResponseRing();
+
+    // Producers: takes buf, or leaves it alone and returns false if the ring is full
+    bool push(std::string &buf);
+
+    // Consumer: returns nullptr if the next slot is not yet filled
+    std::string* front();
+    void pop();
+};
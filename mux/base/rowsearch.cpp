@@ -0,0 +1,137 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "rowsearch.h"
+#include "lib/grapheme.h"
+#include "lib/protocol.h"
+#include "config.h"
+
+#include <algorithm>
+
+static std::string
+escapeLiteral(const std::string &str)
+{
+    std::string result;
+
+    for (char c: str) {
+        if (strchr("^$\\.*+?()[]{}|", c))
+            result.push_back('\\');
+        result.push_back(c);
+    }
+    return result;
+}
+
+index_t
+SearchLine::rowAt(size_t pos) const
+{
+    return row + (std::upper_bound(breaks.begin(), breaks.end(), pos) - breaks.begin());
+}
+
+RowSearch::RowSearch(const std::string &pattern, unsigned flags)
+{
+    if (pattern.size() > SEARCH_MAX_PATTERN)
+        throw std::regex_error(std::regex_constants::error_complexity);
+
+    bool regex = flags & TSQ_SEARCH_REGEX;
+    bool icase = flags & TSQ_SEARCH_ICASE;
+
+    if (regex || !m_matcher.setLiteral(pattern, icase)) {
+        auto rflags = std::regex::nosubs|std::regex::optimize;
+        if (icase)
+            rflags |= std::regex::icase;
+
+        m_regex.assign(regex ? pattern : escapeLiteral(pattern), rflags);
+        m_matcher.setRegex(&m_regex);
+    }
+}
+
+unsigned
+RowSearch::findAll(SearchLine &line, index_t lo, index_t hi,
+                   unsigned max, bool last) const
+{
+    auto &spans = line.spans;
+    size_t pos = 0, start, end;
+    bool cut = false;
+
+    while (max && find(line.str, pos, start, end)) {
+        index_t row = line.rowAt(start);
+        if (row > hi)
+            break;
+        if (row >= lo) {
+            if (spans.size() == max) {
+                cut = true;
+                if (!last)
+                    break;
+                spans.erase(spans.begin());
+            }
+            spans.emplace_back(start, end);
+        }
+        pos = (end > start) ? end : end + 1;
+    }
+
+    if (cut) {
+        // Leave the row that was cut partway through to the next request,
+        // unless its matches alone exceed the limit
+        index_t row = line.rowAt(last ? spans.front().first : spans.back().first);
+        auto same = [&](const std::pair<size_t,size_t> &span) {
+            return line.rowAt(span.first) == row;
+        };
+
+        if (last) {
+            auto i = std::find_if_not(spans.begin(), spans.end(), same);
+            bool partial = i != spans.end();
+            if (partial)
+                spans.erase(spans.begin(), i);
+            line.resume = partial ? row : row - 1;
+        } else {
+            auto i = std::find_if_not(spans.rbegin(), spans.rend(), same);
+            bool partial = i != spans.rend();
+            if (partial)
+                spans.erase(i.base(), spans.end());
+            line.resume = partial ? row : row + 1;
+        }
+    }
+
+    return spans.size();
+}
+
+void
+RowSearch::convert(const SearchLine &line, Tsq::Unicoding *lookup,
+                   std::vector<RowMatch> &results)
+{
+    if (line.spans.empty())
+        return;
+
+    // Convert byte offsets into cluster positions in one pass
+    Tsq::GraphemeWalk tbf(lookup, line.str);
+    auto brk = line.breaks.begin();
+    index_t row = line.row;
+    column_t cur = 0;
+    bool more = tbf.next();
+
+    auto advance = [&]() {
+        more = tbf.next();
+        ++cur;
+        // Positions restart at each continuation row
+        for (; brk != line.breaks.end() && more && tbf.start() >= *brk; ++brk) {
+            ++row;
+            cur = 0;
+        }
+    };
+
+    for (const auto &span: line.spans) {
+        while (more && tbf.end() <= span.first)
+            advance();
+
+        RowMatch &match = results.emplace_back();
+        match.row = row;
+        match.start = match.end = cur;
+
+        while (more && tbf.start() < span.second) {
+            advance();
+            ++match.end;
+        }
+    }
+}
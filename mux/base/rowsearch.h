@@ -0,0 +1,65 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "lib/types.h"
+#include "lib/textmatch.h"
+
+#include <regex>
+#include <vector>
+
+namespace Tsq { class Unicoding; }
+
+struct RowMatch
+{
+    index_t row;
+    column_t start;
+    // Counted from the start of row, may run past it on wrapped lines
+    column_t end;
+};
+
+struct SearchLine
+{
+    // First row of the logical line
+    index_t row;
+    std::string str;
+    // Byte offsets at which each continuation row begins
+    std::vector<size_t> breaks;
+    // Byte spans of matches
+    std::vector<std::pair<size_t,size_t>> spans;
+    // Where to continue if the spans were cut short by the result limit
+    index_t resume = INVALID_INDEX;
+
+    index_t rowAt(size_t pos) const;
+    inline index_t end() const { return row + breaks.size() + 1; }
+};
+
+//
+// Matcher for scrollback search requests
+//
+class RowSearch
+{
+private:
+    std::regex m_regex;
+    Tsq::TextMatcher m_matcher;
+
+public:
+    // Throws std::regex_error for malformed or overlong patterns
+    RowSearch(const std::string &pattern, unsigned flags);
+    RowSearch(const RowSearch &) = delete;
+
+    inline bool find(const std::string &str, size_t pos, size_t &start, size_t &end) const
+    { return m_matcher.find(str, pos, start, end); }
+
+    // Records the spans of up to max matches starting in rows lo to hi,
+    // keeping the last ones rather than the first if last is set.
+    // Returns the count
+    unsigned findAll(SearchLine &line, index_t lo, index_t hi,
+                     unsigned max, bool last) const;
+
+    // Appends the recorded spans of line as per-row cluster positions
+    static void convert(const SearchLine &line, Tsq::Unicoding *lookup,
+                        std::vector<RowMatch> &results);
+};
@@ -0,0 +1,99 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "rowset.h"
+
+#include <algorithm>
+
+void
+RowSet::insertSlow(index_t i)
+{
+    insert(i, i + 1);
+}
+
+void
+RowSet::insert(index_t start, index_t end)
+{
+    if (start >= end)
+        return;
+
+    // Find the spans overlapping or adjacent to [start, end)
+    auto lo = std::lower_bound(m_spans.begin(), m_spans.end(), start,
+                               [](const Interval &s, index_t v) { return s.second < v; });
+    auto hi = std::upper_bound(lo, m_spans.end(), end,
+                               [](index_t v, const Interval &s) { return v < s.first; });
+
+    if (lo == hi) {
+        m_spans.emplace(lo, start, end);
+        m_count += end - start;
+        return;
+    }
+
+    start = std::min(start, lo->first);
+    end = std::max(end, (hi - 1)->second);
+
+    for (auto k = lo; k != hi; ++k)
+        m_count -= k->second - k->first;
+
+    lo->first = start;
+    lo->second = end;
+    m_count += end - start;
+    m_spans.erase(lo + 1, hi);
+}
+
+void
+RowSet::insert(const RowSet &other)
+{
+    for (const auto &span: other.m_spans)
+        insert(span.first, span.second);
+}
+
+void
+RowSet::popFront()
+{
+    Interval &first = m_spans.front();
+
+    if (++first.first == first.second)
+        m_spans.erase(m_spans.begin());
+
+    --m_count;
+}
+
+void
+RowSet::eraseBelow(index_t i)
+{
+    auto k = m_spans.begin(), j = m_spans.end();
+
+    for (; k != j && k->first < i; ++k) {
+        if (k->second > i) {
+            m_count -= i - k->first;
+            k->first = i;
+            break;
+        }
+        m_count -= k->second - k->first;
+    }
+
+    m_spans.erase(m_spans.begin(), k);
+}
+
+void
+RowSet::truncate(size_t count)
+{
+    // Keep only the highest count rows
+    auto k = m_spans.begin(), j = m_spans.end();
+
+    for (; k != j && m_count > count; ++k) {
+        index_t n = k->second - k->first;
+
+        if (m_count - n < count) {
+            k->first += m_count - count;
+            m_count = count;
+            break;
+        }
+        m_count -= n;
+    }
+
+    m_spans.erase(m_spans.begin(), k);
+}
@@ -0,0 +1,95 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "lib/types.h"
+
+#include <vector>
+
+//
+// Sorted set of row indices stored as disjoint half-open intervals
+// Marking the row at or just past the last interval is O(1)
+//
+class RowSet
+{
+private:
+    typedef std::pair<index_t,index_t> Interval;
+    std::vector<Interval> m_spans;
+    size_t m_count = 0;
+
+    void insertSlow(index_t i);
+
+public:
+    class const_iterator
+    {
+        friend class RowSet;
+
+    private:
+        const Interval *m_span, *m_end;
+        index_t m_cur;
+
+        inline const_iterator(const Interval *span, const Interval *end) :
+            m_span(span), m_end(end), m_cur(span != end ? span->first : 0) {}
+
+    public:
+        inline index_t operator*() const { return m_cur; }
+        inline bool operator!=(const const_iterator &o) const {
+            return m_span != o.m_span || m_cur != o.m_cur;
+        }
+        inline const_iterator& operator++() {
+            if (++m_cur == m_span->second)
+                m_cur = (++m_span != m_end) ? m_span->first : 0;
+            return *this;
+        }
+    };
+
+    inline const_iterator begin() const {
+        const Interval *end = m_spans.data() + m_spans.size();
+        return const_iterator(m_spans.data(), end);
+    }
+    inline const_iterator end() const {
+        const Interval *end = m_spans.data() + m_spans.size();
+        return const_iterator(end, end);
+    }
+
+    inline bool empty() const { return m_count == 0; }
+    inline size_t size() const { return m_count; }
+    inline index_t front() const { return m_spans.front().first; }
+
+    inline void insert(index_t i);
+    void insert(index_t start, index_t end);
+    void insert(const RowSet &other);
+
+    void popFront();
+    void eraseBelow(index_t i);
+    void truncate(size_t count);
+    inline void clear() { m_spans.clear(); m_count = 0; }
+};
+
+inline void
+RowSet::insert(index_t i)
+{
+    if (m_spans.empty()) {
+        m_spans.emplace_back(i, i + 1);
+        m_count = 1;
+        return;
+    }
+
+    Interval &last = m_spans.back();
+
+    if (i >= last.first) {
+        if (i == last.second)
+            ++last.second;
+        else if (i > last.second)
+            m_spans.emplace_back(i, i + 1);
+        else
+            return;
+
+        ++m_count;
+        return;
+    }
+
+    insertSlow(i);
+}
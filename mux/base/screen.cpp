@@ -411,6 +411,46 @@ TermScreen::writeCell(const CellAttributes &a, codepoint_t c, int width)
     m_cursor.setSubpos(flags);
 }
 
+unsigned
+TermScreen::writeCells(const CellAttributes &a, const char *str, unsigned n)
+{
+    // Bulk version of writeCell for a run of printable ASCII
+    // Only handles appending at or past the end of the row
+    int x = m_cursor.x();
+    int d = calculateRightBound(*m_row, m_margins.right()) - x;
+
+    if (m_cursor.pastEnd() || d < 0 || m_row->columns() > x)
+        return 0;
+
+    if (m_nextRow) {
+        m_nextRow->flags &= ~Tsq::Continuation;
+        m_buffer->touchRow(m_nextRow, m_cursor.y() + m_offset + 1);
+        m_nextRow = nullptr;
+    }
+    m_buffer->touchRow(m_row, m_cursor.y() + m_offset);
+
+    if (n > (unsigned)d + 1)
+        n = d + 1;
+
+    m_row->pad(x - m_row->columns());
+    m_cursor.rptr() = m_row->append(a, str, n);
+
+    // Advance cursor, stopping on the right bound
+    if (n == (unsigned)d + 1) {
+        if (n > 1) {
+            m_cursor.rx() += n - 1;
+            m_cursor.incPos(n - 1);
+        }
+        m_cursor.setSubpos(Tsq::CursorPastEnd);
+    } else {
+        m_cursor.rx() += n;
+        m_cursor.incPos(n);
+        m_cursor.setSubpos(0);
+    }
+
+    return n;
+}
+
 void
 TermScreen::insertCells(int count)
 {
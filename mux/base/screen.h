@@ -95,6 +95,7 @@ public:
     void deleteRow();
 
     void writeCell(const CellAttributes &a, codepoint_t c, int width);
+    unsigned writeCells(const CellAttributes &a, const char *str, unsigned n);
     void combineCell(const CellAttributes &a, codepoint_t c);
     void insertCells(int count);
     void deleteCell();
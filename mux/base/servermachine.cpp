@@ -13,6 +13,7 @@
 #include "lib/handshake.h"
 #include "lib/raw.h"
 #include "lib/term.h"
+#include "lib/zraw.h"
 #include "config.h"
 
 #include <unistd.h>
@@ -82,6 +83,10 @@ ServerMachine::connRead(const char *buf, size_t len)
         m_parent->m_remoteId = Tsq::Uuid(m_handshake->clientId);
         newMachine = new Tsq::RawProtocol(m_parent, buf, len);
         return m_parent->setMachine(newMachine, -TSQ_PROTOCOL_RAW);
+    case TSQ_PROTOCOL_RAW_ZLIB:
+        m_parent->m_remoteId = Tsq::Uuid(m_handshake->clientId);
+        newMachine = new Tsq::ZlibProtocol(m_parent, buf, len);
+        return m_parent->setMachine(newMachine, -TSQ_PROTOCOL_RAW_ZLIB);
     case TSQ_PROTOCOL_CLIENTFD:
         if (len) {
             LOGNOT("Reader %p: unexpected data after transfer fd request\n", m_parent);
@@ -0,0 +1,89 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "taskwindow.h"
+#include "config.h"
+
+TaskWindow::TaskWindow(uint32_t chunkSize, uint32_t windowSize) :
+    m_chunk(chunkSize ? chunkSize : 1)
+{
+    // Acks arrive per chunk, so keep at least two outstanding
+    m_min = 2 * m_chunk;
+    m_window = (size_t)windowSize * m_chunk;
+    m_max = TASK_WINDOW_MAX / m_chunk * m_chunk;
+
+    // Keep the window a whole number of chunks so probes end on an ack
+    if (m_max < m_window)
+        m_max = m_window;
+
+    if (m_window < m_min)
+        m_window = m_min;
+}
+
+void
+TaskWindow::sent(size_t sent, size_t acked, int64_t now)
+{
+    if (!m_probing) {
+        // The receiver acks once per chunk, so wait for the next boundary
+        m_probing = true;
+        m_probe = (sent + m_chunk - 1) / m_chunk * m_chunk;
+        m_probeTime = now;
+        m_full = false;
+    }
+    if (sent - acked >= m_window)
+        m_full = true;
+    if (m_rateTime == 0)
+        m_rateTime = now;
+}
+
+void
+TaskWindow::acked(size_t acked, int64_t now)
+{
+    if (m_probing && acked >= m_probe) {
+        m_probing = false;
+
+        if (now > m_rateTime) {
+            uint64_t rate = (acked - m_rateAcked) * 1000 / (now - m_rateTime);
+            m_rate = m_rate ? (3 * m_rate + rate) / 4 : rate;
+            m_rateAcked = acked;
+            m_rateTime = now;
+        }
+
+        // Application-limited samples include idle time, discard them
+        if (m_full)
+            adapt(now - m_probeTime);
+    }
+}
+
+void
+TaskWindow::adapt(int64_t sample)
+{
+    // Clock is in milliseconds, local links round to zero
+    if (sample < 1)
+        sample = 1;
+
+    if (m_baseRtt == 0 || m_baseRtt > sample)
+        m_baseRtt = sample;
+
+    m_rtt = m_rtt ? (3 * m_rtt + sample) / 4 : sample;
+
+    // Bytes estimated to be sitting in queues along the path
+    size_t queued = m_window * (m_rtt - m_baseRtt) / m_rtt;
+
+    if (queued < TASK_WINDOW_ALPHA * m_chunk) {
+        m_window = m_slowStart ? 2 * m_window : m_window + m_chunk;
+        if (m_window > m_max)
+            m_window = m_max;
+    }
+    else {
+        m_slowStart = false;
+
+        if (queued > TASK_WINDOW_BETA * m_chunk && m_window > m_min) {
+            m_window -= m_chunk;
+            if (m_window < m_min)
+                m_window = m_min;
+        }
+    }
+}
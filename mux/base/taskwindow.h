@@ -0,0 +1,49 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Delay-based send window for throttlable tasks
+// Grows while acks return promptly, shrinks as round trips inflate
+//
+class TaskWindow
+{
+private:
+    size_t m_chunk;
+    size_t m_window, m_min, m_max;
+    bool m_slowStart = true;
+
+    // One probe in flight per round trip
+    size_t m_probe = 0;
+    int64_t m_probeTime = 0;
+    bool m_probing = false;
+    // Set if the window filled while the probe was in flight
+    bool m_full = false;
+
+    int64_t m_baseRtt = 0, m_rtt = 0;
+    size_t m_rateAcked = 0;
+    int64_t m_rateTime = 0;
+    uint64_t m_rate = 0;
+
+    void adapt(int64_t sample);
+
+public:
+    // The client's requested window is the starting point
+    TaskWindow(uint32_t chunkSize, uint32_t windowSize);
+
+    inline bool open(size_t sent, size_t acked) const
+    { return sent - acked < m_window; }
+
+    void sent(size_t sent, size_t acked, int64_t now);
+    void acked(size_t acked, int64_t now);
+
+    inline size_t window() const { return m_window; }
+    inline int64_t rtt() const { return m_rtt; }
+    // Delivered bytes per second
+    inline uint64_t rate() const { return m_rate; }
+};
@@ -11,6 +11,7 @@
 #include "writer.h"
 #include "listener.h"
 #include "zombies.h"
+#include "rowsearch.h"
 #include "exception.h"
 #include "xterm/xterm.h"
 #include "systemd/scoper.h"
@@ -31,6 +32,7 @@
 #include "lib/attrstr.h"
 #include "config.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <climits>
 #include <unistd.h>
@@ -135,7 +137,60 @@ TermInstance::commandGetRows(uint8_t bufid, index_t start, index_t end,
     buffer->pullRegions(start, end, regions);
 
     while (start < buffer->size() && start < end)
-        rows.emplace_back(buffer->constRow(start++));
+        rows.emplace_back(buffer->copyRow(start++));
+}
+
+index_t
+TermInstance::commandSearchRows(uint8_t bufid, const RowSearch &search,
+                                index_t start, index_t count, bool reverse,
+                                unsigned limit, std::vector<RowMatch> &results)
+{
+    TermBuffer *buffer = m_emulator->buffer(!!bufid);
+    std::vector<SearchLine> lines;
+    index_t low, size, next = INVALID_INDEX;
+    unsigned found = 0;
+    size_t n = 0;
+
+    {
+        // Copy the text out so that matching runs without the lock
+        StateLock slock(this, false);
+        low = buffer->lower();
+        size = buffer->size();
+        start = buffer->copyLines(start, count, reverse, lines);
+    }
+
+    while (n < lines.size() && found < limit) {
+        SearchLine &line = lines[n++];
+        // The first line may extend past the start row
+        found += reverse ?
+            search.findAll(line, 0, start, limit - found, true) :
+            search.findAll(line, start, INVALID_INDEX, limit - found, false);
+    }
+
+    // Where the next request should pick up
+    if (n) {
+        const SearchLine &line = lines[n - 1];
+        if (line.resume != INVALID_INDEX)
+            next = (line.resume >= low && line.resume < size) ? line.resume : INVALID_INDEX;
+        else if (reverse)
+            next = line.row > low ? line.row - 1 : INVALID_INDEX;
+        else
+            next = line.end() < size ? line.end() : INVALID_INDEX;
+    }
+
+    if (found) {
+        Tsq::Unicoding *lookup = m_emulator->unicoding();
+        StateLock slock(this, false);
+
+        for (size_t i = 0; i < n; ++i) {
+            size_t prev = results.size();
+            RowSearch::convert(lines[i], lookup, results);
+            if (reverse)
+                std::reverse(results.begin() + prev, results.end());
+        }
+    }
+
+    return next;
 }
 
 bool
@@ -363,25 +418,19 @@ TermInstance::pushChanges(bool activate)
 void
 TermInstance::handleTermEvent(char *buf, unsigned len, bool running)
 {
-    bool activate = true;
     bool chflags = false;
 
     // update modtime
     m_modTime = osModtime(m_baseTime);
 
     // determine ratelimit status
+    // update frequency is paced by the writers, this only flags busy terminals
     switch (m_rateStatus) {
     case 2:
-        if (m_modTime - m_ratePushTime >= RATELIMIT_INTERVAL) {
-            m_ratePushTime = m_modTime;
-        } else {
-            activate = false;
-        }
         break;
     case 1:
         if (m_modTime - m_rateIdleTime > RATELIMIT_THRESHOLD && !m_haveConnection) {
             m_rateStatus = 2;
-            m_ratePushTime = m_modTime;
             chflags = m_emulator->setFlag(Tsq::RateLimited, true);
         }
         break;
@@ -399,7 +448,7 @@ TermInstance::handleTermEvent(char *buf, unsigned len, bool running)
         !m_emulator->buffer(1)->changedRegions().empty() ||
         !m_emulator->changedAttributes.empty())
         // report changes to watches
-        pushChanges(activate);
+        pushChanges();
 }
 
 void
@@ -561,8 +610,15 @@ bool
 TermInstance::handleIdle()
 {
     // LOGDBG("Term %p: idle at %d\n", this, m_timeout);
-    if (m_status->update(m_fd, m_pid))
-        handleStatusAttributes();
+    int64_t now = osMonotime();
+
+    // Output and work reset the timeout to zero, so while they keep coming
+    // only poll the process once per initial timeout
+    if (m_timeout != 0 || now - m_statusTime >= IDLE_INITIAL_TIMEOUT) {
+        m_statusTime = now;
+        if (m_status->update(m_fd, m_pid))
+            handleStatusAttributes();
+    }
 
     switch (m_timeout) {
     case 0:
@@ -643,6 +699,8 @@ TermInstance::reportAttributeChange(const std::string &key, const std::string &v
 {
     if (key == Tsq::attr_PROFILE_NFILES)
         m_filemon->setLimit(value);
+    else if (key == Tsq::attr_PREF_FILEPAGE)
+        m_filemon->setPage(value);
     else
         m_emulator->reportAttributeChange(key, value);
 }
@@ -724,20 +782,28 @@ TermInstance::handleWork(const WorkItem &item)
 }
 
 void
-TermInstance::threadMain()
+TermInstance::threadStarting()
 {
     m_locale->setLocale();
     m_filemon->start(-1);
     launch();
+}
 
-    try {
-        runDescriptorLoop();
-    }
-    catch (const TsqException &e) {
-        LOGERR("Term %p: %s\n", this, e.what());
+void
+TermInstance::threadResumed()
+{
+    // Pool workers are shared with other terminals
+    m_locale->setLocale();
+}
+
+void
+TermInstance::threadFinished(const std::exception *e)
+{
+    if (dynamic_cast<const TsqException*>(e)) {
+        LOGERR("Term %p: %s\n", this, e->what());
         closefd();
-    } catch (const std::exception &e) {
-        LOGERR("Term %p: caught exception: %s\n", this, e.what());
+    } else if (e) {
+        LOGERR("Term %p: caught exception: %s\n", this, e->what());
         closefd();
     }
 
@@ -755,6 +821,12 @@ TermInstance::threadMain()
     g_listener->sendWork(ListenerRemoveTerm, this);
 }
 
+void
+TermInstance::threadMain()
+{
+    runPoolableLoop();
+}
+
 /*
  * Called by emulator while locked
  */
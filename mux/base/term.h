@@ -18,6 +18,8 @@ class TermFilemon;
 class TermUnicoding;
 class Translator;
 class Region;
+class RowSearch;
+struct RowMatch;
 struct PtyParams;
 struct EmulatorParams;
 
@@ -31,9 +33,10 @@ private:
 
     int32_t m_modTime;
     int32_t m_rateStatus = 0;
-    int32_t m_rateIdleTime, m_ratePushTime;
+    int32_t m_rateIdleTime;
     int64_t m_baseTime;
     int64_t m_launchTime = 0;
+    int64_t m_statusTime = 0;
 
     TermFilemon *m_filemon;
     const Translator *m_translator;
@@ -43,6 +46,9 @@ private:
     std::unordered_set<Region*> m_incomingRegions;
 
     void threadMain();
+    void threadStarting();
+    void threadResumed();
+    void threadFinished(const std::exception *e);
     bool handleFd();
     bool handleWork(const WorkItem &item);
     bool handleIdle();
@@ -97,6 +103,9 @@ public:
     void commandGetRows(uint8_t bufid, index_t start, index_t end,
                         std::vector<CellRow> &rows,
                         std::vector<Region> &regions);
+    index_t commandSearchRows(uint8_t bufid, const RowSearch &search,
+                              index_t start, index_t count, bool reverse,
+                              unsigned limit, std::vector<RowMatch> &results);
     bool commandGetContent(contentid_t id, Tsq::ProtocolMarshaler *m);
     bool commandGetRegion(uint8_t bufid, regionid_t id, Region &region);
     void commandCreateRegion(Region *region);
@@ -21,6 +21,8 @@ public:
     // locked
     TermEventState state;
     StringMap files;
+    // writer only
+    RowShadow shadow[2];
 
 public:
     TermWatch(TermInstance *parent, TermReader *reader);
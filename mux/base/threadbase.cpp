@@ -4,6 +4,7 @@
 
 #include "common.h"
 #include "threadbase.h"
+#include "eventpool.h"
 #include "exception.h"
 #include "os/eventfd.h"
 #include "os/process.h"
@@ -49,6 +50,13 @@ ThreadBase::start(int fd)
 {
     assert(!m_started);
 
+    if (m_poolable && g_pool) {
+        m_fd = fd;
+        g_pool->add(this);
+        m_started = true;
+        return;
+    }
+
     ThreadArg *arg = new ThreadArg;
     arg->obj = this;
     arg->fd = fd;
@@ -73,6 +81,7 @@ ThreadBase::run(int fd)
 
 ThreadBase::ThreadBase(const char *name, unsigned flags) :
     m_usesCondition(flags & ThreadBaseCond),
+    m_poolable(flags & ThreadBasePoolable),
     m_tname(name)
 {
     if (pthread_mutex_init(&m_lock, NULL) < 0)
@@ -190,6 +199,21 @@ ThreadBase::handleIdle()
     return true;
 }
 
+void
+ThreadBase::threadStarting()
+{
+}
+
+void
+ThreadBase::threadResumed()
+{
+}
+
+void
+ThreadBase::threadFinished(const std::exception *)
+{
+}
+
 inline bool
 ThreadBase::nextWorkItem(WorkItem &result)
 {
@@ -295,6 +319,21 @@ ThreadBase::runDescriptorLoopMulti()
     }
 }
 
+void
+ThreadBase::runPoolableLoop()
+{
+    try {
+        threadStarting();
+        runDescriptorLoop();
+    }
+    catch (const std::exception &e) {
+        threadFinished(&e);
+        return;
+    }
+
+    threadFinished(nullptr);
+}
+
 void
 ThreadBase::closefd()
 {
@@ -315,14 +354,19 @@ ThreadBase::closeevents()
 void
 ThreadBase::detach()
 {
-    pthread_detach(m_tid);
+    if (!m_pooled)
+        pthread_detach(m_tid);
 }
 
 void
 ThreadBase::join()
 {
     assert(m_started);
-    pthread_join(m_tid, NULL);
+
+    if (m_pooled)
+        g_pool->join(this);
+    else
+        pthread_join(m_tid, NULL);
     m_started = false;
 }
 
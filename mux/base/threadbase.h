@@ -6,6 +6,7 @@
 
 #include "os/signal.h"
 
+#include <exception>
 #include <queue>
 #include <vector>
 #include <csignal>
@@ -27,6 +28,7 @@ extern "C" void* threadTrampoline(void *arg);
 class ThreadBase
 {
     friend void* threadTrampoline(void *arg);
+    friend class EventPool;
     friend void deathHandler(int signal);
     friend void reloadHandler(int signal);
 
@@ -39,6 +41,15 @@ private:
     bool m_confirmed = false;
     bool m_interrupted = false;
     const bool m_usesCondition;
+    const bool m_poolable;
+
+    // Pooled mode
+    bool m_pooled = false;
+    bool m_poolStarted = false;
+    bool m_poolDone = false;
+    int m_pollfd = -1;
+    int m_timerfd = -1;
+    int m_polled;
 
     pthread_t m_tid;
     const char *m_tname;
@@ -52,6 +63,12 @@ private:
     virtual bool handleIdle();
     virtual bool handleMultiFd(pollfd &pfd);
 
+    // Setup and teardown around the descriptor loop of poolable objects,
+    // which may run on a pool worker instead of a thread of their own
+    virtual void threadStarting();
+    virtual void threadResumed();
+    virtual void threadFinished(const std::exception *e);
+
 protected:
     mutable pthread_mutex_t m_lock;
     pthread_cond_t m_cond;
@@ -67,6 +84,7 @@ protected:
     void runDescriptorLoop();
     void runDescriptorLoopWithoutFd();
     void runDescriptorLoopMulti();
+    void runPoolableLoop();
     void closefd();
 
     inline void setfd(int fd) { m_fds[1].fd = m_fd = fd; }
@@ -82,7 +100,7 @@ protected:
 
     enum ThreadBaseFlags {
         ThreadBaseMulti = 0, ThreadBaseFd = 1, ThreadBaseCond = 2,
-        TaskBaseThrottlable = 4, TaskBaseExclusive = 8
+        TaskBaseThrottlable = 4, TaskBaseExclusive = 8, ThreadBasePoolable = 16
     };
 
 public:
@@ -95,6 +113,7 @@ public:
     inline bool started() const { return m_started; }
     inline bool confirmed() const { return m_confirmed; }
     inline bool interrupted() const { return m_interrupted; }
+    inline bool pooled() const { return m_pooled; }
     inline int exitStatus() const { return m_exitStatus; }
 
     void start(int fd);
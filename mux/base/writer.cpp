@@ -11,16 +11,21 @@
 #include "exception.h"
 #include "os/conn.h"
 #include "os/logging.h"
+#include "os/time.h"
 #include "lib/machine.h"
 #include "lib/protocol.h"
 #include "config.h"
 
 #include <pthread.h>
 #include <unistd.h>
+#include <sys/uio.h>
+#include <ctime>
 
 TermWriter::TermWriter(TermReader *parent) :
     ThreadBase("writer", ThreadBaseCond),
-    m_parent(parent)
+    m_parent(parent),
+    m_ring(WRITER_RING_SIZE),
+    m_frameInterval(WRITER_FRAME_MIN)
 {
     // Temporary location until writer is unblocked
     p_active = new std::set<BaseWatch*,WatchSorter>;
@@ -80,8 +85,10 @@ TermWriter::activate(BaseWatch *watch)
     Lock lock(this);
 
     p_active->insert(watch);
-    m_todo = true;
-    pthread_cond_signal(&m_cond);
+    if (!m_todo) {
+        m_todo = true;
+        pthread_cond_signal(&m_cond);
+    }
 }
 
 void
@@ -90,25 +97,62 @@ TermWriter::requestRelease(BaseWatch *watch)
     Lock lock(this);
 
     m_closing.insert(watch);
-    m_todo = true;
-    pthread_cond_signal(&m_cond);
+    if (!m_todo) {
+        m_todo = true;
+        pthread_cond_signal(&m_cond);
+    }
+}
+
+void
+TermWriter::enableRowDiffs()
+{
+    Lock lock(this);
+
+    m_rowDiffs = true;
+}
+
+bool
+TermWriter::pushOverflow(std::string &buf, bool full)
+{
+    Lock lock(this);
+
+    // Once spilling starts, keep spilling until the writer catches up,
+    // so that no producer's later responses overtake its earlier ones
+    if (!full && !m_overflowing)
+        return false;
+
+    m_overflowing = true;
+    m_overflow.push(std::move(buf));
+    return true;
 }
 
 bool
 TermWriter::submitResponse(std::string &&buf)
 {
     bool retval = true;
+    size_t len = buf.size();
 
-    Lock lock(this);
+    if (m_stopping)
+        return retval;
 
-    if (!m_stopping) {
-        m_bufferedAmount += buf.size();
-        m_responses.push(std::move(buf));
-        if (m_bufferedAmount > BUFFER_WARN_THRESHOLD) {
-            m_throttled = true;
-            retval = false;
+    while (1) {
+        if (!m_overflowing) {
+            if (!m_ring.push(buf))
+                pushOverflow(buf, true);
+            break;
         }
-        m_todo = true;
+        if (pushOverflow(buf, false))
+            break;
+    }
+
+    if (m_bufferedAmount.fetch_add(len) + len > BUFFER_WARN_THRESHOLD) {
+        m_throttled = true;
+        retval = false;
+    }
+
+    // Only wake the writer on the transition from idle
+    if (m_pending.fetch_add(1) == 0) {
+        Lock lock(this);
         pthread_cond_signal(&m_cond);
     }
 
@@ -182,37 +226,111 @@ TermWriter::handleClosingWatch(BaseWatch *watch)
 }
 
 void
-TermWriter::lockLoop()
+TermWriter::drainResponses()
+{
+    Tsq::ProtocolMachine *machine = m_parent->machine();
+    std::string *buf;
+    long count = 0;
+
+    // Bounded so that watches are not starved by a busy producer
+    while (count < WRITER_RING_SIZE && (buf = m_ring.front())) {
+        machine->connSend(buf->data(), buf->size());
+        m_ring.pop();
+        ++count;
+    }
+
+    // Responses spilled while the ring was full follow once it is empty
+    if (m_overflowing && !m_ring.front()) {
+        {
+            Lock lock(this);
+            m_overflow.swap(c_overflow);
+            m_overflowing = false;
+        }
+        while (!c_overflow.empty()) {
+            const std::string &str = c_overflow.front();
+            machine->connSend(str.data(), str.size());
+            c_overflow.pop();
+            ++count;
+        }
+    }
+
+    m_pending -= count;
+}
+
+inline int
+TermWriter::frameDelay() const
+{
+    return m_frameTime + m_frameInterval - osMonotime();
+}
+
+void
+TermWriter::frameWait(int delay)
 {
-    bool wasThrottled;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    ts.tv_sec += delay / 1000;
+    ts.tv_nsec += (delay % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_nsec -= 1000000000L;
+        ++ts.tv_sec;
+    }
+
+    pthread_cond_timedwait(&m_cond, &m_lock, &ts);
+}
+
+void
+TermWriter::frameAdapt(int64_t start)
+{
+    // Sends block while the socket is full, so a slow frame means backpressure
+    int elapsed = osMonotime() - start;
+
+    if (elapsed > m_frameInterval / 2 || m_throttled) {
+        m_frameInterval *= 2;
+        if (m_frameInterval > WRITER_FRAME_MAX)
+            m_frameInterval = WRITER_FRAME_MAX;
+    } else if (m_frameInterval > WRITER_FRAME_MIN) {
+        m_frameInterval -= m_frameInterval / 4;
+        if (m_frameInterval < WRITER_FRAME_MIN)
+            m_frameInterval = WRITER_FRAME_MIN;
+    }
+}
 
+void
+TermWriter::lockLoop()
+{
     while (1) {
+        bool frame;
         {
             Lock lock(this);
 
-            if (!m_stopping && !m_todo)
-                pthread_cond_wait(&m_cond, &m_lock);
+            if (!m_stopping && m_pending <= 0) {
+                int delay;
+                if (!m_todo)
+                    pthread_cond_wait(&m_cond, &m_lock);
+                else if ((delay = frameDelay()) > 0)
+                    frameWait(delay);
+            }
             if (m_stopping || s_deathSignal)
                 break;
 
-            m_responses.swap(c_responses);
-            m_active.swap(c_active);
+            // Responses and closings are never delayed, watch updates
+            // wait for the next frame and pick up everything since
+            if ((frame = m_todo && frameDelay() <= 0)) {
+                m_active.swap(c_active);
+                m_todo = false;
+            }
             m_closing.swap(c_closing);
-
-            m_bufferedAmount = 0;
-            m_todo = false;
-            wasThrottled = m_throttled;
-            m_throttled = false;
+            m_transfer.rowDiffs = m_rowDiffs;
         }
 
-        if (wasThrottled)
+        int64_t start = osMonotime();
+
+        m_bufferedAmount = 0;
+        if (m_throttled.exchange(false))
             TermReader::pushTaskResume(g_listener->id());
 
-        while (!c_responses.empty()) {
-            const std::string &buf = c_responses.front();
-            m_parent->machine()->connSend(buf.data(), buf.size());
-            c_responses.pop();
-        }
+        drainResponses();
 
         for (auto i = c_active.begin(); i != c_active.end(); i = c_active.erase(i))
             switch ((*i)->type) {
@@ -231,6 +349,11 @@ TermWriter::lockLoop()
             handleClosingWatch(*i);
 
         m_parent->machine()->connFlush(nullptr, 0);
+
+        if (frame) {
+            frameAdapt(start);
+            m_frameTime = start;
+        }
     }
 }
 
@@ -284,3 +407,33 @@ TermWriter::writeFd(int fd, const char *buf, size_t len)
         len -= rc;
     }
 }
+
+void
+TermWriter::writevFd(int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt) {
+        ssize_t rc = writev(fd, iov, iovcnt);
+        if (rc < 0) {
+            int code = errno;
+
+            {
+                Lock lock(this);
+                if (m_stopping || s_deathSignal)
+                    throw ErrnoException(EINTR);
+            }
+            if (code == EAGAIN || code == EINTR) {
+                osWaitForWritable(fd);
+                continue;
+            }
+
+            throw ErrnoException("writev", code);
+        }
+        // Skip what was written, resuming partway into a buffer
+        for (; iovcnt && (size_t)rc >= iov->iov_len; ++iov, --iovcnt)
+            rc -= iov->iov_len;
+        if (iovcnt) {
+            iov->iov_base = (char *)iov->iov_base + rc;
+            iov->iov_len -= rc;
+        }
+    }
+}
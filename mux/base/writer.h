@@ -7,10 +7,12 @@
 #include "threadbase.h"
 #include "eventstate.h"
 #include "basewatch.h"
+#include "respring.h"
 
 #include <unordered_set>
 #include <set>
 #include <queue>
+#include <atomic>
 
 class TermWatch;
 
@@ -25,15 +27,32 @@ private:
     std::unordered_set<BaseWatch*> m_watches;
     std::set<BaseWatch*,WatchSorter> *p_active, m_active, c_active;
     std::set<BaseWatch*,WatchSorter> m_closing, c_closing;
-    std::queue<std::string> m_responses, c_responses;
 
-    size_t m_bufferedAmount = 0;
+    // Responses are pushed to the ring without locking, spilling into
+    // the overflow queue under lock while the ring is full
+    ResponseRing m_ring;
+    std::queue<std::string> m_overflow, c_overflow;
+    std::atomic_bool m_overflowing{false};
+    std::atomic_long m_pending{0};
+
+    std::atomic_size_t m_bufferedAmount{0};
+    std::atomic_bool m_throttled{false};
+    std::atomic_bool m_stopping{false};
 
     bool m_todo = false;
-    bool m_stopping = false;
-    bool m_throttled = false;
     bool m_started = false;
+    bool m_rowDiffs = false;
+
+    // Watch updates are coalesced into frames, stretched under backpressure
+    int64_t m_frameTime = 0;
+    int m_frameInterval;
+
+    int frameDelay() const;
+    void frameWait(int delay);
+    void frameAdapt(int64_t start);
 
+    bool pushOverflow(std::string &buf, bool full);
+    void drainResponses();
     void lockLoop();
     void threadMain();
 
@@ -52,10 +71,12 @@ public:
     void addWatch(BaseWatch *watch);
     void activate(BaseWatch *watch);
     void requestRelease(BaseWatch *watch);
+    void enableRowDiffs();
 
     bool submitResponse(std::string &&buf);
 
     void writeFd(int fd, const char *buf, size_t len);
+    void writevFd(int fd, struct iovec *iov, int iovcnt);
 };
 
 inline void BaseWatch::activate()
@@ -100,8 +100,8 @@ extern TermScoper *g_scoper;
 #define sd_stopScoper(reason)
 
 #define sd_prepareScope()
-#define sd_createScope(term, pid)
+#define sd_createScope()
 #define sd_cleanupScope(i)
-#define sd_unregisterTerm(term)
+#define sd_unregisterTerm()
 
 #endif // USE_SYSTEMD
@@ -18,10 +18,15 @@ TermCharset::TermCharset(int left, int right, Charset a, Charset b, Charset c, C
 void
 TermCharset::loadLeft(Charset charset)
 {
+    m_plainLeft = true;
+
     for (int i = 0; i < 128; ++i)
     {
         const Codepoint c = (*charset)[i];
         m_set[i] = (c != 0) ? c : i;
+
+        if (i >= 0x20 && i < 0x7f && m_set[i] != i)
+            m_plainLeft = false;
     }
 
     m_leftSet = charset;
@@ -16,6 +16,7 @@ private:
     Charsets m_charsets;
     int m_left, m_right;
     int m_nextLeft;
+    bool m_plainLeft;
 
     Charset m_leftSet, m_rightSet;
 
@@ -31,6 +32,8 @@ public:
     inline int left() const { return m_left; }
     inline int right() const { return m_right; }
     inline int nextLeft() const { return m_nextLeft; }
+    // True if printable ASCII maps to itself
+    inline bool plain() const { return m_plainLeft && m_nextLeft == -1; }
 
     void setCharset(int pos, Charset charset);
     void setCharsets(const Charsets& charsets, int left, int right, int nextLeft);
@@ -5,17 +5,64 @@
 #include "common.h"
 #include "edgebase.h"
 #include "machine.h"
+#include "config.h"
+
+#include <cassert>
+
+XTermEdge::XTermEdge(char type_, unsigned varnum_) :
+    type(type_),
+    varnum(varnum_),
+    next(0),
+    separator(0),
+    terminators{}
+{
+}
+
+void
+XTermEdge::addTerminator(Codepoint c)
+{
+    // Terminators are stored in a 256-bit set
+    assert(c < 256);
+    terminators[c >> 5] |= (1u << (c & 31));
+}
 
 bool
-XTermEdge::matches(XTermStateMachine *, Codepoint)
+XTermEdge::limited(Codepoint c) const
 {
-    return true;
+    switch (type) {
+    case EDGE_SINGLE_NUMERIC:
+    case EDGE_MULTI_NUMERIC:
+        return !isTerminator(c) && c != separator && c >= '0' && c <= '9';
+    case EDGE_SINGLE_TEXT:
+        return !isTerminator(c) && !XTermStateMachine::isRestartCode(c);
+    default:
+        return false;
+    }
 }
 
-XTermEdge::Disposition
-XTermEdge::process(XTermStateMachine *state, Codepoint c)
+bool
+XTermEdge::matches(Codepoint c, size_t curlen) const
 {
-    state->push(c);
-    state->next();
-    return Move;
+    switch (type) {
+    case EDGE_CONTROL:
+        return XTermStateMachine::isControlCode(c);
+    case EDGE_MULTI_NUMERIC:
+        if (c == separator)
+            return true;
+        // fallthru
+    case EDGE_SINGLE_NUMERIC:
+        if (isTerminator(c))
+            return true;
+        if (curlen > EDGE_NUMERIC_MAX)
+            return false;
+        return (c >= '0' && c <= '9');
+    case EDGE_SINGLE_TEXT:
+        if (isTerminator(c))
+            return true;
+        if (curlen > SEQUENCE_FIELD_MAX)
+            return false;
+        return !XTermStateMachine::isRestartCode(c);
+    default:
+        return true;
+    }
 }
@@ -4,31 +4,35 @@
 
 #pragma once
 
-#include "base/codestring.h"
+#include "base/codepoint.h"
 
 #define EDGE_SINGLE_NUMERIC '\xff'
 #define EDGE_MULTI_NUMERIC  '\xfe'
 #define EDGE_SINGLE_TEXT    '\xfd'
 #define EDGE_SINGLE_CHAR    '\xfc'
 #define EDGE_OTHER          '\0'
+#define EDGE_CONTROL        '\x01'
 
-class XTermNode;
-class XTermStateMachine;
+#define EDGE_NUMERIC_MAX 32
 
-class XTermEdge
+struct XTermEdge
 {
-protected:
-    int m_varnum = 0;
-
-public:
-    virtual ~XTermEdge() = default;
+    enum Disposition { Stay, Move, Skip, Restart, Reset, Call };
 
-    virtual char type() { return EDGE_OTHER; };
+    char type;
+    uint8_t varnum;
+    uint16_t next;
+    Codepoint separator;
+    uint32_t terminators[8];
 
-    enum Disposition { Stay, Move, Skip, Restart, Reset, Call };
+    XTermEdge(char type, unsigned varnum = 0);
 
-    XTermNode *next = nullptr;
+    inline bool isTerminator(Codepoint c) const {
+        return c < 256 && terminators[c >> 5] & (1u << (c & 31));
+    }
+    void addTerminator(Codepoint c);
 
-    virtual bool matches(XTermStateMachine *state, Codepoint c);
-    virtual Disposition process(XTermStateMachine *state, Codepoint c);
+    // Whether a match on c depends on the length of the current field
+    bool limited(Codepoint c) const;
+    bool matches(Codepoint c, size_t curlen) const;
 };
@@ -4,12 +4,10 @@
 
 #include "common.h"
 #include "graph.h"
-#include "edgesinglechar.h"
-#include "edgesinglenum.h"
-#include "edgemultinum.h"
-#include "edgesingletext.h"
 #include "xterm.h"
 
+#include <map>
+
 // EDGE_SINGLE_NUMERIC '\xff'
 // EDGE_MULTI_NUMERIC  '\xfe'
 // EDGE_SINGLE_TEXT    '\xfd'
@@ -113,124 +111,111 @@ static const struct command s_commands[] = {
     { NULL }
 };
 
-XTermNode *
-XTermRootNode::addLiteralEdge(XTermNode *cur, Codepoint val)
+unsigned
+XTermGraph::addNode()
+{
+    unsigned node = m_nodes.size();
+    m_nodes.emplace_back();
+    return node;
+}
+
+unsigned
+XTermGraph::addEdge(unsigned cur, char type, unsigned varnum)
 {
-    XTermNode::EdgeMap &edgeMap = cur->edgeMap;
+    unsigned edge = m_edges.size();
+    m_edges.emplace_back(type, varnum);
+    m_edges.back().next = addNode();
+
+    // Special edges take priority over earlier ones, control edge is last
+    auto &edgeList = m_nodes[cur].edgeList;
+    edgeList.insert(edgeList.begin(), edge);
+    return edge;
+}
 
-    auto i = edgeMap.find(val);
-    if (i != edgeMap.end()) {
-        return i->second->next;
+unsigned
+XTermGraph::findEdge(unsigned cur, char type)
+{
+    for (unsigned edge: m_nodes[cur].edgeList)
+        if (m_edges[edge].type == type)
+            return edge;
+
+    return GRAPH_NO_EDGE;
+}
+
+unsigned
+XTermGraph::addLiteralEdge(unsigned cur, Codepoint val)
+{
+    auto i = m_nodes[cur].edgeMap.find(val);
+    if (i != m_nodes[cur].edgeMap.end()) {
+        return m_edges[i->second].next;
     }
 
-    XTermEdge *edge = new XTermEdge();
-    m_edges.push_back(edge);
-    XTermNode *node = new XTermNode(&e_control);
-    m_nodes.push_back(node);
+    unsigned edge = m_edges.size();
+    m_edges.emplace_back(EDGE_OTHER);
+    unsigned node = addNode();
+    m_nodes[node].edgeList.push_back(0);
 
-    edge->next = node;
-    edgeMap.emplace(val, edge);
+    m_edges[edge].next = node;
+    m_nodes[cur].edgeMap.emplace(val, edge);
     return node;
 }
 
-XTermNode *
-XTermRootNode::addSingleCharEdge(XTermNode *cur, int varnum)
+unsigned
+XTermGraph::addSingleCharEdge(unsigned cur, int varnum)
 {
-    XTermEdge *edge = new XTermSingleCharEdge(varnum);
-    m_edges.push_back(edge);
-    XTermNode *node = new XTermNode(&e_control);
-    m_nodes.push_back(node);
-
-    edge->next = node;
-    cur->edgeList.insert(cur->edgeList.begin(), edge);
+    unsigned edge = addEdge(cur, EDGE_SINGLE_CHAR, varnum);
+    unsigned node = m_edges[edge].next;
+    m_nodes[node].edgeList.push_back(0);
     return node;
 }
 
-XTermNode *
-XTermRootNode::addSingleNumericEdge(XTermNode *cur, int varnum, Codepoint terminator)
+unsigned
+XTermGraph::addSingleNumericEdge(unsigned cur, int varnum, Codepoint terminator)
 {
-    XTermEdge *edge;
-    XTermNode *node;
-    XTermNode::EdgeList &edgeList = cur->edgeList;
-    XTermNode::EdgeList::const_iterator i = edgeList.begin();
-    XTermNode::EdgeList::const_iterator j = edgeList.end();
-
-    for (; i != j; ++i) {
-        edge = *i;
-        if (edge->type() == EDGE_SINGLE_NUMERIC) {
-            static_cast<XTermSingleNumericEdge*>(edge)->addTerminator(terminator);
-            return addLiteralEdge(edge->next, terminator);
-        }
-    }
+    unsigned edge = findEdge(cur, EDGE_SINGLE_NUMERIC);
 
-    edge = new XTermSingleNumericEdge(varnum, terminator);
-    m_edges.push_back(edge);
-    node = new XTermNode(&e_control);
-    m_nodes.push_back(node);
+    if (edge == GRAPH_NO_EDGE) {
+        edge = addEdge(cur, EDGE_SINGLE_NUMERIC, varnum);
+        m_nodes[m_edges[edge].next].edgeList.push_back(0);
+    }
 
-    edge->next = node;
-    cur->edgeList.insert(cur->edgeList.begin(), edge);
-    return addLiteralEdge(node, terminator);
+    m_edges[edge].addTerminator(terminator);
+    return addLiteralEdge(m_edges[edge].next, terminator);
 }
 
-XTermNode *
-XTermRootNode::addMultiNumericEdge(XTermNode *cur, int varnum, Codepoint separator, Codepoint terminator)
+unsigned
+XTermGraph::addMultiNumericEdge(unsigned cur, int varnum, Codepoint separator, Codepoint terminator)
 {
-    XTermEdge *edge;
-    XTermNode *node;
-    XTermNode::EdgeList &edgeList = cur->edgeList;
-    XTermNode::EdgeList::const_iterator i = edgeList.begin();
-    XTermNode::EdgeList::const_iterator j = edgeList.end();
-
-    for (; i != j; ++i) {
-        edge = *i;
-        if (edge->type() == EDGE_MULTI_NUMERIC) {
-            static_cast<XTermMultiNumericEdge*>(edge)->addTerminator(terminator);
-            return addLiteralEdge(edge->next, terminator);
-        }
-    }
+    unsigned edge = findEdge(cur, EDGE_MULTI_NUMERIC);
 
-    edge = new XTermMultiNumericEdge(varnum, separator, terminator);
-    m_edges.push_back(edge);
-    node = new XTermNode(&e_control);
-    m_nodes.push_back(node);
+    if (edge == GRAPH_NO_EDGE) {
+        edge = addEdge(cur, EDGE_MULTI_NUMERIC, varnum);
+        m_edges[edge].separator = separator;
+        m_nodes[m_edges[edge].next].edgeList.push_back(0);
+    }
 
-    edge->next = node;
-    cur->edgeList.insert(cur->edgeList.begin(), edge);
-    return addLiteralEdge(node, terminator);
+    m_edges[edge].addTerminator(terminator);
+    return addLiteralEdge(m_edges[edge].next, terminator);
 }
 
-XTermNode *
-XTermRootNode::addSingleTextEdge(XTermNode *cur, int varnum, Codepoint terminator)
+unsigned
+XTermGraph::addSingleTextEdge(unsigned cur, int varnum, Codepoint terminator)
 {
-    XTermEdge *edge;
-    XTermNode *node;
-    XTermNode::EdgeList &edgeList = cur->edgeList;
-    XTermNode::EdgeList::const_iterator i = edgeList.begin();
-    XTermNode::EdgeList::const_iterator j = edgeList.end();
-
-    for (; i != j; ++i) {
-        edge = *i;
-        if (edge->type() == EDGE_SINGLE_TEXT) {
-            static_cast<XTermSingleTextEdge*>(edge)->addTerminator(terminator);
-            return addLiteralEdge(edge->next, terminator);
-        }
-    }
+    unsigned edge = findEdge(cur, EDGE_SINGLE_TEXT);
 
-    edge = new XTermSingleTextEdge(varnum, terminator);
-    m_edges.push_back(edge);
-    node = new XTermNode(&e_control);
-    m_nodes.push_back(node);
+    if (edge == GRAPH_NO_EDGE) {
+        edge = addEdge(cur, EDGE_SINGLE_TEXT, varnum);
+        m_nodes[m_edges[edge].next].edgeList.push_back(0);
+    }
 
-    edge->next = node;
-    cur->edgeList.insert(cur->edgeList.begin(), edge);
-    return addLiteralEdge(node, terminator);
+    m_edges[edge].addTerminator(terminator);
+    return addLiteralEdge(m_edges[edge].next, terminator);
 }
 
 void
-XTermRootNode::addCommand(XTermNode *root, const struct command *command)
+XTermGraph::addCommand(const struct command *command)
 {
-    XTermNode *cur = root;
+    unsigned cur = GRAPH_ROOT;
     const char *ptr = command->sequence;
     int varnum = 0;
     unsigned char separator, terminus;
@@ -261,46 +246,101 @@ XTermRootNode::addCommand(XTermNode *root, const struct command *command)
         ++ptr;
     }
 
-    cur->isLeaf = true;
-    cur->setSlot(command->slot);
-    cur->setSlotName(command->slotName);
+    XTermNode &node = m_nodes[cur];
+    node.isLeaf = true;
+    node.slot = command->slot;
+    node.slotName = command->slotName;
 }
 
-XTermRootNode::XTermRootNode(): XTermNode(&e_control)
+uint16_t
+XTermGraph::scan(unsigned node, Codepoint c, size_t curlen) const
 {
-    // Remove default edges
-    edgeList.clear();
+    const XTermNode &n = m_nodes[node];
 
-    // Add commands
-    for (int i = 0; s_commands[i].sequence; ++i)
+    auto i = n.edgeMap.find(c);
+    if (i != n.edgeMap.end()) {
+        return i->second;
+    }
+
+    for (unsigned edge: n.edgeList)
     {
-        addCommand(this, s_commands + i);
+        if (m_edges[edge].matches(c, curlen))
+            return edge;
+    }
+
+    return GRAPH_NO_EDGE;
+}
+
+uint16_t
+XTermGraph::scanAll(unsigned node, Codepoint c) const
+{
+    // Match ignoring field length limits
+    uint16_t edge = scan(node, c, 0);
+
+    if (edge != GRAPH_NO_EDGE && m_edges[edge].limited(c))
+        edge |= GRAPH_LIMITED;
+
+    return edge;
+}
+
+void
+XTermGraph::compile()
+{
+    // Build one column per byte (plus one for everything above 255)
+    std::vector<std::vector<uint16_t>> columns(257);
+    for (unsigned c = 0; c < 257; ++c)
+        for (unsigned node = 0; node < m_nodes.size(); ++node)
+            columns[c].push_back(scanAll(node, c));
+
+    // Merge identical columns into byte classes
+    std::map<std::vector<uint16_t>,uint8_t> classes;
+    for (unsigned c = 0; c < 257; ++c) {
+        auto i = classes.emplace(columns[c], classes.size()).first;
+        m_classes[c] = i->second;
     }
 
-    // Control edge
-    XTermNode *node = new XTermNode(&e_control);
-    m_nodes.push_back(node);
+    m_nclasses = classes.size();
+    m_table.resize(m_nodes.size() * m_nclasses);
 
-    node->isLeaf = true;
-    node->setSlot(&XTermEmulator::process);
-    node->setSlotName("process");
-    e_control.next = node;
+    for (const auto &i: classes)
+        for (unsigned node = 0; node < m_nodes.size(); ++node)
+            m_table[node * m_nclasses + i.second] = i.first[node];
+}
+
+XTermGraph::XTermGraph()
+{
+    // Root node, then control edge (index 0) and its leaf
+    addNode();
+    m_edges.emplace_back(EDGE_CONTROL);
+    unsigned node = addNode();
+    m_edges[0].next = node;
+    m_nodes[node].isLeaf = true;
+    m_nodes[node].slot = &XTermEmulator::process;
+    m_nodes[node].slotName = "process";
+
+    // Add commands
+    for (int i = 0; s_commands[i].sequence; ++i)
+    {
+        addCommand(s_commands + i);
+    }
 
     // Print edge
-    XTermEdge *edge = new XTermEdge();
-    m_edges.push_back(edge);
-    node = new XTermNode(&e_control);
-    m_nodes.push_back(node);
-
-    node->isLeaf = true;
-    node->setSlot(&XTermEmulator::process);
-    node->setSlotName("process");
-    edge->next = node;
-    edgeList.push_back(edge);
+    unsigned edge = m_edges.size();
+    m_edges.emplace_back(EDGE_OTHER);
+    node = addNode();
+    m_edges[edge].next = node;
+    m_nodes[node].edgeList.push_back(0);
+    m_nodes[node].isLeaf = true;
+    m_nodes[node].slot = &XTermEmulator::process;
+    m_nodes[node].slotName = "process";
+    m_nodes[GRAPH_ROOT].edgeList.push_back(edge);
+
+    compile();
 }
 
-XTermRootNode::~XTermRootNode()
+const XTermGraph *
+XTermGraph::instance()
 {
-    forDeleteAll(m_nodes);
-    forDeleteAll(m_edges);
+    static const XTermGraph s_graph;
+    return &s_graph;
 }
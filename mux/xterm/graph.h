@@ -5,28 +5,53 @@
 #pragma once
 
 #include "nodebase.h"
-#include "edgecontrol.h"
+#include "edgebase.h"
 
 #include <vector>
 
-class XTermRootNode final: public XTermNode
+#define GRAPH_ROOT 0
+#define GRAPH_NO_EDGE 0xffff
+#define GRAPH_LIMITED 0x8000
+
+//
+// Control sequence graph compiled into a flat byte-class transition table
+// Built once at startup and shared by all emulators
+//
+class XTermGraph
 {
 private:
-    XTermControlEdge e_control;
+    std::vector<XTermNode> m_nodes;
+    std::vector<XTermEdge> m_edges;
+
+    // Byte classes: codepoints at or above 256 map to class of 256
+    uint8_t m_classes[257];
+    unsigned m_nclasses;
+    std::vector<uint16_t> m_table;
 
-    // Used by destructor only
-    std::vector<XTermNode*> m_nodes;
-    std::vector<XTermEdge*> m_edges;
+    unsigned addNode();
+    unsigned addEdge(unsigned cur, char type, unsigned varnum);
+    unsigned findEdge(unsigned cur, char type);
 
-    XTermNode* addLiteralEdge(XTermNode *cur, Codepoint val);
-    XTermNode* addSingleCharEdge(XTermNode *cur, int varnum);
-    XTermNode* addSingleNumericEdge(XTermNode *cur, int varnum, Codepoint terminator);
-    XTermNode* addMultiNumericEdge(XTermNode *cur, int varnum, Codepoint separator, Codepoint terminator);
-    XTermNode* addSingleTextEdge(XTermNode *cur, int varnum, Codepoint terminator);
+    unsigned addLiteralEdge(unsigned cur, Codepoint val);
+    unsigned addSingleCharEdge(unsigned cur, int varnum);
+    unsigned addSingleNumericEdge(unsigned cur, int varnum, Codepoint terminator);
+    unsigned addMultiNumericEdge(unsigned cur, int varnum, Codepoint separator, Codepoint terminator);
+    unsigned addSingleTextEdge(unsigned cur, int varnum, Codepoint terminator);
 
-    void addCommand(XTermNode *root, const struct command *command);
+    void addCommand(const struct command *command);
+    uint16_t scanAll(unsigned node, Codepoint c) const;
+    void compile();
+
+    XTermGraph();
 
 public:
-    XTermRootNode();
-    ~XTermRootNode();
+    static const XTermGraph *instance();
+
+    inline const XTermNode& node(unsigned i) const { return m_nodes[i]; }
+    inline const XTermEdge& edge(unsigned i) const { return m_edges[i]; }
+
+    inline uint16_t lookup(unsigned node, Codepoint c) const {
+        return m_table[node * m_nclasses + m_classes[c < 256 ? c : 256]];
+    }
+    uint16_t scan(unsigned node, Codepoint c, size_t curlen) const;
 };
@@ -7,6 +7,7 @@
 #include "xterm.h"
 #include "app/args.h"
 #include "os/logging.h"
+#include "config.h"
 
 #include <sstream>
 
@@ -19,80 +20,85 @@ static const Codestring s_mtcs;
 
 XTermStateMachine::XTermStateMachine(XTermEmulator *emulator,
                                      const Translator *translator) :
-    m_node(&m_root),
+    m_graph(XTermGraph::instance()),
     m_emulator(emulator),
     m_translator(translator)
 {
 }
 
-Codestring &
-XTermStateMachine::varref(int varnum)
+XTermParams
+XTermStateMachine::nums(int varnum) const
 {
-    // Unchecked
-    return m_vars.find(varnum)->second;
-}
+    // Parameters are pushed in variable order
+    const int *i = m_params, *j = m_params + m_nparams;
+    const uint8_t *v = m_paramVars;
 
-const Codestring &
-XTermStateMachine::var(int varnum) const
-{
-    auto i = m_vars.find(varnum);
-    auto j = m_vars.end();
+    while (i != j && *v != varnum)
+        ++i, ++v;
 
-    return (i != j) ? i->second : s_mtcs;
+    const int *k = i;
+    while (k != j && *v == varnum)
+        ++k, ++v;
+
+    return XTermParams{ i, k };
 }
 
-std::vector<const Codestring*>
-XTermStateMachine::varList(int varnum) const
+int
+XTermStateMachine::num(int varnum) const
 {
-    std::vector<const Codestring*> list;
-    auto range = m_vars.equal_range(varnum);
-    auto i = range.first;
-    auto j = range.second;
-
-    while (i != j) {
-        list.push_back(&i->second);
-        ++i;
-    }
-
-    return list;
+    XTermParams params = nums(varnum);
+    return params.empty() ? 0 : params[0];
 }
 
-unsigned
-XTermStateMachine::varCount(int varnum) const
+const Codestring &
+XTermStateMachine::text(int varnum) const
 {
-    auto range = m_vars.equal_range(varnum);
-    return std::distance(range.first, range.second);
+    return (m_textVar == varnum) ? m_text : s_mtcs;
 }
 
 void
 XTermStateMachine::reset()
 {
-    m_node = &m_root;
+    m_node = GRAPH_ROOT;
 
     m_curSequence.clear();
     m_allSequence.clear();
-    m_vars.clear();
+    m_nparams = 0;
+    m_textVar = -1;
 
     m_haveEsc = false;
 }
 
-void
-XTermStateMachine::next()
+inline void
+XTermStateMachine::push(Codepoint c)
 {
-    m_curSequence.clear();
+    m_curSequence.push_back(c);
+    m_allSequence.push_back(c);
 }
 
 void
-XTermStateMachine::push(Codepoint c)
+XTermStateMachine::pushNum(int varnum)
 {
-    m_curSequence.push_back(c);
-    m_allSequence.push_back(c);
+    // Parameters past the maximum are ignored, as in xterm
+    if (m_nparams < MAX_PARAMS) {
+        int result = 0;
+        const char *ptr = m_curSequence.c_str();
+
+        while (result < 10000 && *ptr >= '0' && *ptr <= '9') {
+            result = (result * 10) + (*ptr++ - '0');
+        }
+
+        m_params[m_nparams] = result;
+        m_paramVars[m_nparams++] = varnum;
+    }
 }
 
 void
-XTermStateMachine::pushVar(int varnum, const Codestring &str)
+XTermStateMachine::pushText(int varnum)
 {
-    m_vars.emplace(varnum, str);
+    // Steal the current buffer, the old one is cleared and reused
+    m_text.rstr().swap(m_curSequence.rstr());
+    m_textVar = varnum;
 }
 
 std::string
@@ -139,11 +145,11 @@ out:
 }
 
 void
-XTermStateMachine::call(const XTermNode *node)
+XTermStateMachine::call(const XTermNode &node)
 {
-    XTermHandler slot = node->slot();
+    XTermHandler slot = node.slot;
 
-    // const char *slotName = node->slotName();
+    // const char *slotName = node.slotName;
     // if (*slotName != 'p') // process
     // LOGDBG("%s\n", dumpState(slotName).c_str());
 
@@ -162,46 +168,111 @@ XTermStateMachine::dumpError(const char *msg, bool restart)
     m_emulator->internalError(result.c_str());
 }
 
+inline XTermEdge::Disposition
+XTermStateMachine::processEdge(const XTermEdge &e, Codepoint c)
+{
+    XTermEdge::Disposition rc;
+
+    switch (e.type) {
+    case EDGE_CONTROL:
+        if (isRestartCode(c)) {
+            rc = m_allSequence.empty() ? XTermEdge::Move : XTermEdge::Restart;
+        } else {
+            rc = XTermEdge::Call;
+        }
+        push(c);
+        // Don't start a new sequence due to embedded control chars
+        return rc;
+    case EDGE_SINGLE_CHAR:
+        m_text.clear();
+        m_text.push_back(c);
+        m_textVar = e.varnum;
+        push(c);
+        next();
+        return XTermEdge::Move;
+    case EDGE_MULTI_NUMERIC:
+        if (c == e.separator) {
+            pushNum(e.varnum);
+            push(c);
+            next();
+            return XTermEdge::Stay;
+        }
+        // fallthru
+    case EDGE_SINGLE_NUMERIC:
+        if (e.isTerminator(c)) {
+            pushNum(e.varnum);
+            next();
+            return XTermEdge::Skip;
+        }
+        push(c);
+        return XTermEdge::Stay;
+    case EDGE_SINGLE_TEXT:
+        if (e.isTerminator(c)) {
+            pushText(e.varnum);
+            next();
+            return XTermEdge::Skip;
+        }
+        push(c);
+        return XTermEdge::Stay;
+    default:
+        push(c);
+        next();
+        return XTermEdge::Move;
+    }
+}
+
 void
 XTermStateMachine::processMain(Codepoint c)
 {
-    XTermEdge *e = m_node->process(this, c);
+    uint16_t idx = m_graph->lookup(m_node, c);
+
+    if (idx != GRAPH_NO_EDGE && (idx & GRAPH_LIMITED)) {
+        const XTermEdge &e = m_graph->edge(idx & ~GRAPH_LIMITED);
+        size_t limit = (e.type == EDGE_SINGLE_TEXT) ? SEQUENCE_FIELD_MAX : EDGE_NUMERIC_MAX;
 
-    if (e == nullptr) {
+        // Overlong field: fall back to matching edges in order
+        idx = (m_curSequence.str().size() > limit) ?
+            m_graph->scan(m_node, c, m_curSequence.str().size()) :
+            idx & ~GRAPH_LIMITED;
+    }
+
+    if (idx == GRAPH_NO_EDGE) {
         m_allSequence.push_back(c);
         dumpError(TR_ERROR1, true);
+        return;
     }
-    else {
-        switch (e->process(this, c))
-        {
-        case XTermEdge::Move:
-            m_node = e->next;
-            if (m_node->isLeaf) {
-                call(m_node);
-                reset();
-            }
-            break;
-        case XTermEdge::Call:
-            call(e->next);
-            m_curSequence.pop_back();
-            m_allSequence.pop_back();
-            break;
-        case XTermEdge::Skip:
-            m_node = e->next;
-            processMain(c);
-            break;
-        case XTermEdge::Reset:
-            // dumpState("Reset");
-            reset();
-            break;
-        case XTermEdge::Restart:
-            // dumpState("Restart");
+
+    const XTermEdge &e = m_graph->edge(idx);
+
+    switch (processEdge(e, c))
+    {
+    case XTermEdge::Move:
+        m_node = e.next;
+        if (m_graph->node(m_node).isLeaf) {
+            call(m_graph->node(m_node));
             reset();
-            process(c);
-            break;
-        default:
-            break;
         }
+        break;
+    case XTermEdge::Call:
+        call(m_graph->node(e.next));
+        m_curSequence.pop_back();
+        m_allSequence.pop_back();
+        break;
+    case XTermEdge::Skip:
+        m_node = e.next;
+        processMain(c);
+        break;
+    case XTermEdge::Reset:
+        // dumpState("Reset");
+        reset();
+        break;
+    case XTermEdge::Restart:
+        // dumpState("Restart");
+        reset();
+        process(c);
+        break;
+    default:
+        break;
     }
 }
 
@@ -7,29 +7,51 @@
 #include "base/codestring.h"
 #include "graph.h"
 
-#include <map>
-#include <vector>
+#define MAX_PARAMS 32
 
 class XTermEmulator;
-class XTermNode;
 class Translator;
 
+// List of numeric parameters belonging to one variable
+struct XTermParams
+{
+    const int *b, *e;
+
+    inline const int *begin() const { return b; }
+    inline const int *end() const { return e; }
+    inline unsigned size() const { return e - b; }
+    inline bool empty() const { return b == e; }
+    inline int operator[](unsigned i) const { return b[i]; }
+};
+
 class XTermStateMachine
 {
 private:
-    XTermRootNode m_root;
-    XTermNode *m_node;
+    const XTermGraph *m_graph;
+    unsigned m_node = GRAPH_ROOT;
 
     XTermEmulator *m_emulator;
 
     Codestring m_curSequence;
     Codestring m_allSequence;
-    std::multimap<int,Codestring> m_vars;
     bool m_haveEsc = false;
 
+    // Variables: numeric parameters in order, plus at most one text field
+    int m_params[MAX_PARAMS];
+    uint8_t m_paramVars[MAX_PARAMS];
+    unsigned m_nparams = 0;
+    int m_textVar = -1;
+    Codestring m_text;
+
     const Translator *m_translator;
 
     void processMain(Codepoint c);
+    XTermEdge::Disposition processEdge(const XTermEdge &e, Codepoint c);
+
+    void push(Codepoint c);
+    void pushNum(int varnum);
+    void pushText(int varnum);
+    inline void next() { m_curSequence.clear(); }
 
 public:
     XTermStateMachine(XTermEmulator *emulator, const Translator *translator);
@@ -39,23 +61,21 @@ public:
     static bool isControlCode(Codepoint c);
     static bool isRestartCode(Codepoint c);
 
+    inline bool idle() const { return m_node == GRAPH_ROOT && !m_haveEsc; }
     inline const Codestring& allSequence() { return m_allSequence; };
     inline const Codestring& curSequence() { return m_curSequence; };
 
-    const Codestring& var(int varnum) const;
-    std::vector<const Codestring*> varList(int varnum) const;
-    unsigned varCount(int varnum) const;
-    Codestring& varref(int varnum);
-
-    void push(Codepoint c);
-    void pushVar(int varnum, const Codestring &str);
-    void next();
+    int num(int varnum) const;
+    XTermParams nums(int varnum) const;
+    inline unsigned numCount(int varnum) const { return nums(varnum).size(); }
+    const Codestring& text(int varnum) const;
+    inline Codestring& textref(int) { return m_text; } // Unchecked
 
     std::string dumpState(const char *msg);
     void dumpError(const char *msg, bool restart);
 
     void process(Codepoint c);
-    void call(const XTermNode *node);
+    void call(const XTermNode &node);
 };
 
 inline bool
@@ -9,31 +9,19 @@
 #include <unordered_map>
 #include <vector>
 
-class XTermEdge;
-class XTermStateMachine;
 class XTermEmulator;
 typedef void (XTermEmulator::*XTermHandler)();
 
-class XTermNode
+struct XTermNode
 {
-private:
-    XTermHandler m_slot;
-    const char *m_slotName = nullptr;
-
-public:
-    XTermNode(XTermEdge *fallbackEdge);
+    XTermHandler slot = nullptr;
+    const char *slotName = nullptr;
+    bool isLeaf = false;
 
-    typedef std::unordered_map<Codepoint,XTermEdge*> EdgeMap;
+    // Edge indices, used to compile the transition table
+    // and as the slow path for overlong fields
+    typedef std::unordered_map<Codepoint,unsigned> EdgeMap;
     EdgeMap edgeMap;
-    typedef std::vector<XTermEdge*> EdgeList;
+    typedef std::vector<unsigned> EdgeList;
     EdgeList edgeList;
-
-    bool isLeaf = false;
-    inline XTermHandler slot() const { return m_slot; };
-    inline const char *slotName() const { return m_slotName; }
-
-    void setSlot(XTermHandler slot) { m_slot = slot; };
-    void setSlotName(const char *slotName) { m_slotName = slotName; }
-
-    XTermEdge *process(XTermStateMachine *state, Codepoint c);
 };
@@ -121,8 +121,14 @@ XTermEmulator::termEvent(char *buf, unsigned len, bool running, bool chflags)
     Cursor savedCursor = cursor();
 
     try {
-        while (i != j)
+        while (i != j) {
+            if (m_state.idle()) {
+                printableRun(i, j);
+                if (i == j)
+                    break;
+            }
             m_state.process(utf8::next(i, j));
+        }
     }
     catch (const utf8::not_enough_room &) {
         off = j - i;
@@ -469,6 +475,75 @@ XTermEmulator::printable(const Codepoint c)
     }
 }
 
+void
+XTermEmulator::printableAscii(const char *i, const char *j)
+{
+    if (!m_charset.plain() || m_flags & Tsq::InsertMode) {
+        while (i != j)
+            printable(m_charset.map(*i++));
+        return;
+    }
+
+    CellAttributes a(m_attributes);
+
+    while (i != j) {
+        unsigned n = m_screen->writeCells(a, i, j - i);
+        if (n == 0) {
+            // Wrapping or overwriting
+            m_unicoding->restart(*i);
+            printableCell(a, *i, 1);
+            n = 1;
+        }
+        i += n;
+    }
+
+    m_unicoding->restart(j[-1]);
+}
+
+static inline const char *
+scanAscii(const char *i, const char *j)
+{
+    // Find the end of a run of printable ASCII, 8 bytes at a time
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+
+    while (j - i >= 8) {
+        uint64_t w;
+        memcpy(&w, i, 8);
+        // Any byte below 0x20, or at/above 0x7f
+        if (((w - ones * 0x20) & ~w & highs) || ((w + ones) | w) & highs)
+            break;
+        i += 8;
+    }
+    while (i != j && (unsigned char)*i >= 0x20 && (unsigned char)*i < 0x7f)
+        ++i;
+
+    return i;
+}
+
+void
+XTermEmulator::printableRun(const char *&i, const char *j)
+{
+    // Fast path for printable text outside of any control sequence
+    // Stops at the first C0/C1 control, leaving i pointing at it
+    while (i != j) {
+        unsigned char c = *i;
+
+        if (c >= 0x20 && c < 0x7f) {
+            const char *k = scanAscii(i, j);
+            printableAscii(i, k);
+            i = k;
+        }
+        else if (c > 0xc2 || (c == 0xc2 && j - i > 1 && (unsigned char)i[1] >= 0xa0)) {
+            // Non-ASCII; C1 controls are all encoded as C2 80-9F
+            printable(m_charset.map(utf8::next(i, j)));
+        }
+        else {
+            break;
+        }
+    }
+}
+
 void
 XTermEmulator::process()
 {
@@ -682,7 +757,7 @@ XTermEmulator::cmdInvokeCharset()
 void
 XTermEmulator::cmdInsertCharacters()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -693,7 +768,7 @@ XTermEmulator::cmdInsertCharacters()
 void
 XTermEmulator::cmdCursorUp()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -704,7 +779,7 @@ XTermEmulator::cmdCursorUp()
 void
 XTermEmulator::cmdCursorDown()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -715,7 +790,7 @@ XTermEmulator::cmdCursorDown()
 void
 XTermEmulator::cmdCursorForward()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -726,7 +801,7 @@ XTermEmulator::cmdCursorForward()
 void
 XTermEmulator::cmdCursorBackward()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -737,7 +812,7 @@ XTermEmulator::cmdCursorBackward()
 void
 XTermEmulator::cmdCursorNextLine()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -749,7 +824,7 @@ XTermEmulator::cmdCursorNextLine()
 void
 XTermEmulator::cmdCursorPreviousLine()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -761,7 +836,7 @@ XTermEmulator::cmdCursorPreviousLine()
 void
 XTermEmulator::cmdCursorHorizontalAbsolute()
 {
-    int col = m_state.var(0).toUInt();
+    int col = m_state.num(0);
 
     if (col != 0)
         --col;
@@ -772,9 +847,9 @@ XTermEmulator::cmdCursorHorizontalAbsolute()
 void
 XTermEmulator::cmdCursorPosition()
 {
-    auto vars = m_state.varList(0);
-    int row = (vars.size() > 0) ? vars[0]->toUInt() : 0;
-    int col = (vars.size() > 1) ? vars[1]->toUInt() : 0;
+    auto vars = m_state.nums(0);
+    int row = (vars.size() > 0) ? vars[0] : 0;
+    int col = (vars.size() > 1) ? vars[1] : 0;
 
     if (row != 0)
         --row;
@@ -788,7 +863,7 @@ XTermEmulator::cmdCursorPosition()
 void
 XTermEmulator::cmdTabForward()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -800,7 +875,7 @@ XTermEmulator::cmdTabForward()
 void
 XTermEmulator::cmdEraseInDisplay()
 {
-    eraseInDisplay(m_state.var(0).toUInt());
+    eraseInDisplay(m_state.num(0));
 }
 
 void
@@ -811,7 +886,7 @@ XTermEmulator::cmdSelectiveEraseInDisplay()
 
     // XXX clear line attributes on full line erase?
 
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 0:
         while (!it.done) {
             if (it.y == p.y())
@@ -851,7 +926,7 @@ XTermEmulator::cmdEraseInLine()
     bool pastEnd = m_screen->cursor().pastEnd();
     int x = m_screen->cursor().x() + pastEnd;
 
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 0:
         row.resize(x, m_unicoding);
         break;
@@ -875,7 +950,7 @@ XTermEmulator::cmdSelectiveEraseInLine()
     bool pastEnd = m_screen->cursor().pastEnd();
     int x = m_screen->cursor().x() + pastEnd;
 
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 0:
         row.selectiveErase(x, row.columns(), m_unicoding);
         break;
@@ -895,7 +970,7 @@ XTermEmulator::cmdSelectiveEraseInLine()
 void
 XTermEmulator::cmdInsertLines()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -907,7 +982,7 @@ XTermEmulator::cmdInsertLines()
 void
 XTermEmulator::cmdDeleteLines()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -919,7 +994,7 @@ XTermEmulator::cmdDeleteLines()
 void
 XTermEmulator::cmdDeleteCharacters()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -931,7 +1006,7 @@ XTermEmulator::cmdDeleteCharacters()
 void
 XTermEmulator::cmdScrollUp()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -943,12 +1018,12 @@ XTermEmulator::cmdScrollUp()
 void
 XTermEmulator::cmdScrollDown()
 {
-    if (m_state.varCount(0) > 1) {
+    if (m_state.numCount(0) > 1) {
         // Highlight mouse tracking (unsupported)
         return;
     }
 
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -960,8 +1035,8 @@ XTermEmulator::cmdScrollDown()
 void
 XTermEmulator::cmdResetTitleModes()
 {
-    for (const Codestring *var: m_state.varList(0)) {
-        switch (var->toUInt()) {
+    for (int var: m_state.nums(0)) {
+        switch (var) {
         case 0:
             m_flags &= ~Tsq::TitleModeSetHex;
             break;
@@ -975,8 +1050,8 @@ XTermEmulator::cmdResetTitleModes()
 void
 XTermEmulator::cmdSetTitleModes()
 {
-    for (const Codestring *var: m_state.varList(0)) {
-        switch (var->toUInt()) {
+    for (int var: m_state.nums(0)) {
+        switch (var) {
         case 0:
             m_flags |= Tsq::TitleModeSetHex;
             break;
@@ -990,7 +1065,7 @@ XTermEmulator::cmdSetTitleModes()
 void
 XTermEmulator::cmdEraseCharacters()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
     CellRow &row = m_screen->row();
     int x = m_screen->cursor().x();
 
@@ -1003,7 +1078,7 @@ XTermEmulator::cmdEraseCharacters()
 void
 XTermEmulator::cmdTabBackward()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -1015,7 +1090,7 @@ XTermEmulator::cmdTabBackward()
 void
 XTermEmulator::cmdRepeatCharacter()
 {
-    int times = m_state.var(0).toUInt();
+    int times = m_state.num(0);
 
     if (times == 0)
         times = 1;
@@ -1034,7 +1109,7 @@ XTermEmulator::cmdRepeatCharacter()
 void
 XTermEmulator::cmdCursorVerticalAbsolute()
 {
-    int row = m_state.var(0).toUInt();
+    int row = m_state.num(0);
 
     if (row != 0)
         --row;
@@ -1045,7 +1120,7 @@ XTermEmulator::cmdCursorVerticalAbsolute()
 void
 XTermEmulator::cmdTabClear()
 {
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 0:
         m_tabs->clearTabStop(m_screen->cursor().x());
         break;
@@ -1058,8 +1133,8 @@ XTermEmulator::cmdTabClear()
 void
 XTermEmulator::cmdSetMode()
 {
-    for (const Codestring *var: m_state.varList(0)) {
-        switch (var->toUInt()) {
+    for (int var: m_state.nums(0)) {
+        switch (var) {
         case 2:
             m_flags |= Tsq::KeyboardLock;
             continue;
@@ -1199,15 +1274,15 @@ XTermEmulator::setPrivateMode(int mode)
 void
 XTermEmulator::cmdDECPrivateModeSet()
 {
-    for (const Codestring *var: m_state.varList(0))
-        setPrivateMode(var->toUInt());
+    for (int var: m_state.nums(0))
+        setPrivateMode(var);
 }
 
 void
 XTermEmulator::cmdDECPrivateModeSave()
 {
-    for (const Codestring *var: m_state.varList(0)) {
-        int arg = var->toUInt();
+    for (int var: m_state.nums(0)) {
+        int arg = var;
         switch (arg) {
         case 1:
             m_savedModes[arg] = m_flags & Tsq::AppCuKeys;
@@ -1293,8 +1368,8 @@ XTermEmulator::cmdDECPrivateModeSave()
 void
 XTermEmulator::cmdResetMode()
 {
-    for (const Codestring *var: m_state.varList(0)) {
-        switch (var->toUInt()) {
+    for (int var: m_state.nums(0)) {
+        switch (var) {
         case 2:
             m_flags &= ~Tsq::KeyboardLock;
             continue;
@@ -1412,15 +1487,15 @@ XTermEmulator::resetPrivateMode(int mode)
 void
 XTermEmulator::cmdDECPrivateModeReset()
 {
-    for (const Codestring *var: m_state.varList(0))
-        resetPrivateMode(var->toUInt());
+    for (int var: m_state.nums(0))
+        resetPrivateMode(var);
 }
 
 void
 XTermEmulator::cmdDECPrivateModeRestore()
 {
-    for (const Codestring *var: m_state.varList(0)) {
-        int arg = var->toUInt();
+    for (int var: m_state.nums(0)) {
+        int arg = var;
         auto j = m_savedModes.find(arg);
         if (j != m_savedModes.end() && j->second)
             setPrivateMode(arg);
@@ -1432,7 +1507,7 @@ XTermEmulator::cmdDECPrivateModeRestore()
 void
 XTermEmulator::cmdCharacterAttributes()
 {
-    auto vars = m_state.varList(0);
+    auto vars = m_state.nums(0);
     uint8_t r, g, b;
 
     if (vars.size() == 0) {
@@ -1441,7 +1516,7 @@ XTermEmulator::cmdCharacterAttributes()
     }
     for (int i = 0, n = vars.size(); i < n; ++i)
     {
-        int arg = vars[i]->toUInt();
+        int arg = vars[i];
         switch (arg) {
         case 0:
             m_attributes.flags &= ~Tsq::All;
@@ -1540,24 +1615,24 @@ XTermEmulator::cmdCharacterAttributes()
         if (arg == 38 || arg == 48) {
             if (++i == n)
                 break;
-            switch (vars[i]->toUInt()) {
+            switch (vars[i]) {
             case 5:
                 if (++i == n)
                     return;
                 if (arg == 38) {
                     m_attributes.flags |= Tsq::Fg|Tsq::FgIndex;
-                    m_attributes.fg = vars[i]->toUInt();
+                    m_attributes.fg = vars[i];
                 } else {
                     m_attributes.flags |= Tsq::Bg|Tsq::BgIndex;
-                    m_attributes.bg = vars[i]->toUInt();
+                    m_attributes.bg = vars[i];
                 }
                 break;
             case 2:
                 if (n - i < 4)
                     return;
-                r = vars[++i]->toUInt();
-                g = vars[++i]->toUInt();
-                b = vars[++i]->toUInt();
+                r = vars[++i];
+                g = vars[++i];
+                b = vars[++i];
                 if (arg == 38) {
                     m_attributes.flags |= Tsq::Fg;
                     m_attributes.flags &= ~Tsq::FgIndex;
@@ -1594,7 +1669,7 @@ XTermEmulator::cmdCharacterAttributes()
 void
 XTermEmulator::cmdProtectionAttribute()
 {
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 0:
     case 2:
         m_attributes.flags &= ~Tsq::Protected;
@@ -1608,7 +1683,7 @@ XTermEmulator::cmdProtectionAttribute()
 void
 XTermEmulator::cmdSetCursorStyle()
 {
-    unsigned arg = m_state.var(0).toUInt();
+    unsigned arg = m_state.num(0);
     if (arg == 0)
         arg = 1;
     if (arg <= 6)
@@ -1619,9 +1694,9 @@ void
 XTermEmulator::cmdSetTopBottomMargins()
 {
     int h = m_screen->height();
-    auto vars = m_state.varList(0);
-    int top = (vars.size() > 0) ? vars[0]->toUInt() : 1;
-    int bot = (vars.size() > 1) ? vars[1]->toUInt() : h;
+    auto vars = m_state.nums(0);
+    int top = (vars.size() > 0) ? vars[0] : 1;
+    int bot = (vars.size() > 1) ? vars[1] : h;
 
     if (top == 0)
         top = 1;
@@ -1643,7 +1718,7 @@ XTermEmulator::cmdSetTopBottomMargins()
 void
 XTermEmulator::cmdSetLeftRightMargins()
 {
-    auto vars = m_state.varList(0);
+    auto vars = m_state.nums(0);
 
     if (!(m_flags & Tsq::LeftRightMarginMode) && vars.empty()) {
         cmdSaveCursor();
@@ -1651,8 +1726,8 @@ XTermEmulator::cmdSetLeftRightMargins()
     }
 
     int w = m_screen->width();
-    int left = (vars.size() > 0) ? vars[0]->toUInt() : 1;
-    int right = (vars.size() > 1) ? vars[1]->toUInt() : w;
+    int left = (vars.size() > 0) ? vars[0] : 1;
+    int right = (vars.size() > 1) ? vars[1] : w;
 
     if (left == 0)
         left = 1;
@@ -42,6 +42,8 @@ private:
     void printableCell(const CellAttributes &a, const Codepoint c, int width);
     void printableSpecial(const CellAttributes &a, int width);
     void printable(const Codepoint c);
+    void printableAscii(const char *i, const char *j);
+    void printableRun(const char *&i, const char *j);
 
     void setPrivateMode(int mode);
     void resetPrivateMode(int mode);
@@ -19,7 +19,7 @@ using namespace std;
 void
 XTermEmulator::cmdModeRequest()
 {
-    int mode = m_state.var(0).toUInt(), reply = -1;
+    int mode = m_state.num(0), reply = -1;
 
     switch (mode) {
     case 2:
@@ -44,7 +44,7 @@ XTermEmulator::cmdModeRequest()
 void
 XTermEmulator::cmdDECPrivateModeRequest()
 {
-    int mode = m_state.var(0).toUInt(), reply = -1;
+    int mode = m_state.num(0), reply = -1;
 
     switch (mode) {
     case 1:
@@ -174,7 +174,7 @@ XTermEmulator::cmdDECPrivateModeRequest()
 void
 XTermEmulator::cmdSendDeviceAttributes()
 {
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 0:
         termReply("\xc2\x9b?64;1;2;6;9;15;18;21;22c");
         break;
@@ -184,7 +184,7 @@ XTermEmulator::cmdSendDeviceAttributes()
 void
 XTermEmulator::cmdSendDeviceAttributes2()
 {
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 0:
         termReply("\xc2\x9b>41;327;0c");
         break;
@@ -197,7 +197,7 @@ XTermEmulator::cmdDeviceStatusReport()
     char buf[32];
     Point cursor = m_screen->cursor();
 
-    switch (m_state.var(0).toUInt()) {
+    switch (m_state.num(0)) {
     case 5:
         termReply("\xc2\x9b""0n");
         break;
@@ -223,7 +223,7 @@ XTermEmulator::cmdIgnored()
 void
 XTermEmulator::dcsRequestStatusString()
 {
-    const Codestring &str = m_state.var(0);
+    const Codestring &str = m_state.text(0);
     char buf[256] = "\x18";
 
     if (str == "\"p") {
@@ -324,7 +324,7 @@ XTermEmulator::cmdWindowOps()
 {
     string data;
     char buf[32];
-    int arg = m_state.var(0).toUInt();
+    int arg = m_state.num(0);
 
     switch (arg) {
     case 11:
@@ -361,7 +361,7 @@ XTermEmulator::cmdWindowOps()
         termReply(data.data());
         break;
     case 22:
-        switch (arg = m_state.var(1).toUInt()) {
+        switch (arg = m_state.num(1)) {
         case 0:
             m_titleStack.push(m_parent->getAttribute(Tsq::attr_SESSION_TITLE));
             // fallthru
@@ -373,7 +373,7 @@ XTermEmulator::cmdWindowOps()
         }
         break;
     case 23:
-        switch (arg = m_state.var(1).toUInt()) {
+        switch (arg = m_state.num(1)) {
         case 0:
         case 1:
             if (!m_title2Stack.empty()) {
@@ -800,10 +800,10 @@ XTermEmulator::osc133()
     removeAttribute(Tsq::attr_COMMAND);
     m_attributes.flags &= ~(Tsq::Prompt|Tsq::Command);
 
-    if (m_altActive || m_state.var(1).empty())
+    if (m_altActive || m_state.text(1).empty())
         return;
 
-    Codestring &cs = m_state.varref(1);
+    Codestring &cs = m_state.textref(1);
 
     switch(cs.front()) {
     case 'A':
@@ -1058,15 +1058,15 @@ XTermEmulator::osc1337(string &str)
 void
 XTermEmulator::oscMain()
 {
-    const Codestring &text = m_state.var(1);
-    int arg = m_state.var(0).toUInt();
+    const Codestring &text = m_state.text(1);
+    int arg = m_state.num(0);
 
     switch (arg) {
     case 0:
     case 1:
     case 2:
         if (!text.empty())
-            osc0(m_state.varref(1).rstr(), arg);
+            osc0(m_state.textref(1).rstr(), arg);
         break;
     case 3:
         osc3(text.str());
@@ -1085,7 +1085,7 @@ XTermEmulator::oscMain()
         break;
     case 8:
         if (!text.empty())
-            osc8(m_state.varref(1).rstr(), "8");
+            osc8(m_state.textref(1).rstr(), "8");
         break;
     case 9:
         // unsupported
@@ -1100,7 +1100,7 @@ XTermEmulator::oscMain()
     case 17:
     case 18:
     case 19:
-        osc10(text.str(), m_state.var(0).toUInt());
+        osc10(text.str(), m_state.num(0));
         break;
     case 46:
     case 50:
@@ -1126,7 +1126,7 @@ XTermEmulator::oscMain()
     case 117:
     case 118:
     case 119:
-        osc110(m_state.var(0).toUInt());
+        osc110(m_state.num(0));
         break;
     case 133:
     case 1333: // seems to happen in an undersize terminal
@@ -1140,22 +1140,22 @@ XTermEmulator::oscMain()
         break;
     case 513:
         if (!text.empty())
-            osc513(m_state.varref(1).rstr());
+            osc513(m_state.textref(1).rstr());
         break;
     case 514:
         if (!text.empty())
-            osc514(m_state.varref(1).rstr());
+            osc514(m_state.textref(1).rstr());
         break;
     case 515:
         if (!text.empty())
-            osc8(m_state.varref(1).rstr(), "515");
+            osc8(m_state.textref(1).rstr(), "515");
         break;
     case 777:
         // unsupported
         break;
     case 1337:
         if (!text.empty())
-            osc1337(m_state.varref(1).rstr());
+            osc1337(m_state.textref(1).rstr());
         break;
     default:
         m_state.dumpError("Unimplemented os command", false);
@@ -273,6 +273,24 @@ osCreateNamedPipe(bool ro, unsigned mode, std::string &pathret)
     }
 }
 
+int
+osCreateSpillFile()
+{
+    if (!*s_dirpath)
+        throw Tsq::TsqException(ERR4);
+
+    std::string path(s_dirpath);
+    path.append("/sXXXXXX");
+
+    int fd = mkostemp(&path[0], O_CLOEXEC);
+    if (fd < 0)
+        throw Tsq::ErrnoException("mkostemp", path.c_str(), errno);
+
+    // Unlinked immediately, removed when closed
+    unlink(path.c_str());
+    return fd;
+}
+
 static bool
 findBinHelper(const char *name, char *pathbuf, size_t pathlen)
 {
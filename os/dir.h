@@ -31,5 +31,8 @@ osCreateMountPath(const std::string &id, std::string &result);
 extern int
 osCreateNamedPipe(bool ro, unsigned mode, std::string &result);
 
+extern int
+osCreateSpillFile();
+
 extern bool
 osFindBin(const char *name);
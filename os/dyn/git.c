@@ -33,8 +33,13 @@ DECLSYM(git_repository_free);
 DECLSYM(git_repository_head);
 DECLSYM(git_repository_head_detached);
 DECLSYM(git_repository_open_ext);
+DECLSYM(git_repository_path);
 DECLSYM(git_repository_workdir);
+DECLSYM(git_status_byindex);
 DECLSYM(git_status_file);
+DECLSYM(git_status_list_entrycount);
+DECLSYM(git_status_list_free);
+DECLSYM(git_status_list_new);
 
 #define LOADSYM(x) ok = ok && (p_ ## x = dlsym(h, #x))
 
@@ -69,8 +74,13 @@ osLoadLibgit2()
     LOADSYM(git_repository_head);
     LOADSYM(git_repository_head_detached);
     LOADSYM(git_repository_open_ext);
+    LOADSYM(git_repository_path);
     LOADSYM(git_repository_workdir);
+    LOADSYM(git_status_byindex);
     LOADSYM(git_status_file);
+    LOADSYM(git_status_list_entrycount);
+    LOADSYM(git_status_list_free);
+    LOADSYM(git_status_list_new);
 
     if (ok) {
         (*p_git_libgit2_init)();
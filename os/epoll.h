@@ -0,0 +1,59 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+static inline int
+osCreateTimer()
+{
+    return timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+}
+
+// Fire once after timeout milliseconds, or disarm if negative
+static inline void
+osSetTimer(int fd, int timeout)
+{
+    struct itimerspec its = {};
+
+    if (timeout > 0) {
+        its.it_value.tv_sec = timeout / 1000;
+        its.it_value.tv_nsec = (timeout % 1000) * 1000000;
+    } else if (timeout == 0) {
+        its.it_value.tv_nsec = 1;
+    }
+
+    timerfd_settime(fd, 0, &its, NULL);
+}
+
+#else
+#include <cstdint>
+
+struct epoll_event {
+    uint32_t events;
+    union {
+        void *ptr;
+        int fd;
+    } data;
+};
+
+#define EPOLLIN 1
+#define EPOLLONESHOT 0
+#define EPOLL_CLOEXEC 0
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define epoll_create1(x) (errno = ENOTSUP, -1)
+#define epoll_ctl(x, y, z, w) (errno = ENOTSUP, -1)
+#define epoll_wait(x, y, z, w) (errno = ENOTSUP, -1)
+
+#define osCreateTimer() (errno = ENOTSUP, -1)
+#define osSetTimer(x, y)
+#endif
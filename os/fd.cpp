@@ -16,6 +16,9 @@
 #include <dirent.h>
 #include <fts.h>
 #include <vector>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 int
 osOpenFile(const char *name, size_t *sizeret, uint32_t *moderet)
@@ -111,6 +114,50 @@ osReadDir(DIR *dir, FileInfo *info)
     return osStatFile(ent->d_name, info) + 1;
 }
 
+#ifdef __linux__
+struct LinuxDirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+int
+osListDir(DIR *dir, std::string &names)
+{
+    // Read many entries per system call, without going through readdir
+    char buf[65536];
+    int fd = dirfd(dir), count = 0;
+    long rc;
+
+    while ((rc = syscall(SYS_getdents64, fd, buf, sizeof(buf))) > 0) {
+        for (long pos = 0; pos < rc; ++count) {
+            auto *ent = reinterpret_cast<const LinuxDirent64 *>(buf + pos);
+            names.append(ent->d_name, strlen(ent->d_name) + 1);
+            pos += ent->d_reclen;
+        }
+    }
+
+    return rc < 0 ? -1 : count;
+}
+#else
+int
+osListDir(DIR *dir, std::string &names)
+{
+    struct dirent *ent;
+    int count = 0;
+
+    errno = 0;
+    while ((ent = readdir(dir))) {
+        names.append(ent->d_name, strlen(ent->d_name) + 1);
+        ++count;
+    }
+
+    return errno ? -1 : count;
+}
+#endif
+
 bool
 osFileExists(const char *path, bool *isdirret)
 {
@@ -56,6 +56,11 @@ osStatFile(const char *name, FileInfo *info);
 extern int
 osReadDir(DIR *dir, FileInfo *info);
 
+// Appends all entry names to names, NUL-terminated
+// Returns the number of names read or -1 on error
+extern int
+osListDir(DIR *dir, std::string &names);
+
 extern bool
 osFileExists(const char *path, bool *isdirret = nullptr);
 
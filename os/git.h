@@ -25,8 +25,13 @@ extern DECLSYM(git_repository_free);
 extern DECLSYM(git_repository_head);
 extern DECLSYM(git_repository_head_detached);
 extern DECLSYM(git_repository_open_ext);
+extern DECLSYM(git_repository_path);
 extern DECLSYM(git_repository_workdir);
+extern DECLSYM(git_status_byindex);
 extern DECLSYM(git_status_file);
+extern DECLSYM(git_status_list_entrycount);
+extern DECLSYM(git_status_list_free);
+extern DECLSYM(git_status_list_new);
 
 #ifndef LIBGIT2_NO_IFACE
 #define git_branch_name(...) (*p_git_branch_name)(__VA_ARGS__)
@@ -46,8 +51,13 @@ extern DECLSYM(git_status_file);
 #define git_repository_head(...) (*p_git_repository_head)(__VA_ARGS__)
 #define git_repository_head_detached(...) (*p_git_repository_head_detached)(__VA_ARGS__)
 #define git_repository_open_ext(...) (*p_git_repository_open_ext)(__VA_ARGS__)
+#define git_repository_path(...) (*p_git_repository_path)(__VA_ARGS__)
 #define git_repository_workdir(...) (*p_git_repository_workdir)(__VA_ARGS__)
+#define git_status_byindex(...) (*p_git_status_byindex)(__VA_ARGS__)
 #define git_status_file(...) (*p_git_status_file)(__VA_ARGS__)
+#define git_status_list_entrycount(...) (*p_git_status_list_entrycount)(__VA_ARGS__)
+#define git_status_list_free(...) (*p_git_status_list_free)(__VA_ARGS__)
+#define git_status_list_new(...) (*p_git_status_list_new)(__VA_ARGS__)
 #endif
 
 #ifdef __cplusplus
@@ -40,7 +40,7 @@ osStatusTeardown(void *data)
     auto *state = static_cast<LinuxStatusState*>(data);
 
     if (state->fd_cwd != -1)
-        close(state->fd_comm);
+        close(state->fd_cwd);
     if (state->fd_comm != -1)
         close(state->fd_comm);
     if (state->fd_cmdline != -1)
@@ -13,6 +13,7 @@
 #include "base/thumbicon.h"
 #include "base/termwidget.h"
 #include "base/dragicon.h"
+#include "base/scanner.h"
 #include "settings/settings.h"
 #include "settings/state.h"
 #include "settings/setupdialog.h"
@@ -33,6 +34,7 @@ TermApplication::TermApplication(QApplication *app) :
 
     g_logwin = new LogWindow;
     g_datastore = new DatastoreController;
+    g_scanner = new ScanController;
 
     Plugin::initialize();
     TermManager::initialize();
@@ -138,6 +140,7 @@ TermApplication::cleanup()
 
     delete m_box;
     delete g_listener;
+    delete g_scanner;
     delete g_datastore;
     delete g_logwin;
     delete g_settings;
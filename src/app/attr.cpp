@@ -127,6 +127,7 @@ const QString g_attr_PREF_ROW(L(TSQ_ATTR_PREF_ROW));
 const QString g_attr_PREF_MODTIME(L(TSQ_ATTR_PREF_MODTIME));
 const QString g_attr_PREF_JOB(L(TSQ_ATTR_PREF_JOB));
 const QString g_attr_PREF_INPUT(L(TSQ_ATTR_PREF_INPUT));
+const QString g_attr_PREF_FILEPAGE(L(TSQ_ATTR_PREF_FILEPAGE));
 
 const QString g_attr_SESSION_PREFIX(L(TSQ_ATTR_SESSION_PREFIX));
 const QString g_attr_SESSION_PALETTE(L(TSQ_ATTR_SESSION_PALETTE));
@@ -130,6 +130,7 @@ extern const QString g_attr_PREF_ROW;
 extern const QString g_attr_PREF_MODTIME;
 extern const QString g_attr_PREF_JOB;
 extern const QString g_attr_PREF_INPUT;
+extern const QString g_attr_PREF_FILEPAGE;
 
 extern const QString g_attr_SESSION_PREFIX;
 extern const QString g_attr_SESSION_PALETTE;
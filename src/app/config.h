@@ -71,6 +71,8 @@
 #define PROFILE_STACK_MAX 8
 /* Maximum paste size that does not launch a task */
 #define PASTE_SIZE_THRESHOLD 524288
+/* Maximum number of cached text widths per font */
+#define WIDTH_CACHE_MAX 8192
 
 /* Time to wait for additional server registrations */
 #define POPULATE_TIME 1000
@@ -218,12 +220,24 @@
 #define MAX_CONTINUATION 64
 /* Number of additional lines to prefetch when scanning */
 #define SCAN_PREFETCH 255
+/* Maximum number of downloaded lines handed to the scanner at once */
+#define SCAN_BATCH_SIZE 16384
+/* Number of logical lines scanned between cancellation checks */
+#define SCAN_CHECK_INTERVAL 256
+/* Number of rows the server searches per request when scanning */
+#define SCAN_REMOTE_ROWS 8192
 /* Number of lines to process/fetch per fetchtimer iteration */
 #define FETCH_PREFETCH 50
 /* Minimum idle time before fetchtimer will act */
 #define FETCH_IDLE_MIN 50
 /* Number of terminals handled per fetchtimer callback */
 #define FETCH_BATCH_SIZE 8
+/* Initial round trip estimate for viewport fetches (ms) */
+#define FETCH_RTT_INITIAL 100
+/* Scroll samples further apart than this reset the velocity (ms) */
+#define FETCH_VELOCITY_WINDOW 500
+/* Maximum number of lines to prefetch ahead of a scrolling viewport */
+#define FETCH_AHEAD_MAX 2000
 /* Number of lines to process per semantic parser iteration */
 #define SEMANTIC_BATCH_SIZE 256
 
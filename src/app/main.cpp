@@ -18,6 +18,7 @@
 #include "os/plugins.h"
 #include "os/attr.h"
 #include "os/locale.h"
+#include "lib/types.h"
 
 #include <QApplication>
 #include <QTranslator>
@@ -155,6 +156,7 @@ main(int argc, char **argv)
 
     Q_INIT_RESOURCE(resource);
     qRegisterMetaType<AttributeMap>("AttributeMap");
+    qRegisterMetaType<index_t>("index_t");
     s_prevHandler = qInstallMessageHandler(logMessageHandler);
 
     {
@@ -14,20 +14,15 @@
 #include "builder.h"
 #include "listener.h"
 #include "sembase.h"
+#include "urlscan.h"
 #include "lib/grapheme.h"
 #include "lib/utf8.h"
+#include "lib/rowdiff.h"
 
 #include <QSet>
 #include <regex>
 #include <cassert>
 
-static const std::regex s_urlre(
-    "\\b(?:(?:https?|ftp|file)://|info:|man:)"
-    "(?:\\([-_[:alnum:]+&@#/%=~|$?!:,.\\\\]*\\)|[-_[:alnum:]+&@#/%=~|$?!:,.\\\\])*"
-    "(?:\\([-_[:alnum:]+&@#/%=~|$?!:,.\\\\]*\\)|[_[:alnum:]+&@#/%=~|$\\\\])",
-    std::regex::nosubs|std::regex::optimize|std::regex::icase
-    );
-
 TermBuffer::TermBuffer(TermBuffers *parent, uint8_t bufid):
     BufferBase(parent->term()),
     m_parent(parent),
@@ -531,13 +526,24 @@ TermBuffer::handleContentRegion(Region *r)
 }
 
 void
-TermBuffer::updateRow(CellRow &row, index_t index)
+TermBuffer::updateRow(CellRow &row)
 {
-    CellBuilder builder(row);
-    CellAttributes attr;
+    // Identifies this layout of the row to display caches
+    static uint32_t s_revision;
+    if (++s_revision == 0)
+        ++s_revision;
 
-    row.cells.clear();
+    row.revision = s_revision;
     row.regionState = m_parent->regionState();
+}
+
+void
+TermBuffer::expandRow(size_t i, std::vector<Cell> &cells) const
+{
+    const CellRow &row = this->row(i);
+    index_t index = m_origin + i;
+    CellBuilder builder(cells);
+    CellAttributes attr;
 
     const CellRange *rcur = row.ranges.data();
     const CellRange *rend = rcur + row.ranges.size();
@@ -583,7 +589,6 @@ TermBuffer::updateRow(CellRow &row, index_t index)
     }
 
     builder.finish();
-    row.size = pos;
 }
 
 bool
@@ -662,11 +667,11 @@ TermBuffer::updateRows(size_t start, size_t end, RegionList *regionret)
                 regionret->list.push_back(*i);
     }
 
-    for (; start < end; ++start, ++rownum)
+    for (; start < end; ++start)
     {
         CellRow &r = row(start);
         if (r.regionState != m_parent->regionState())
-            updateRow(r, rownum);
+            updateRow(r);
     }
 }
 
@@ -680,7 +685,7 @@ TermBuffer::searchRows(size_t start, size_t end)
     {
         CellRow &r = row(start);
         if (searchRow(r))
-            updateRow(r, rownum);
+            updateRow(r);
         if (r.flags & Tsqt::SearchHit)
             result = rownum;
     }
@@ -688,7 +693,7 @@ TermBuffer::searchRows(size_t start, size_t end)
     return result;
 }
 
-void
+index_t
 TermBuffer::fetchRows(size_t start, size_t end)
 {
     index_t startnum = m_origin + start;
@@ -707,9 +712,10 @@ TermBuffer::fetchRows(size_t start, size_t end)
         if ((r.flags & Tsqt::Downloaded) == 0)
         {
             g_listener->pushTermFetch(m_term, startnum, endnum, m_bufid);
-            break;
+            return startnum;
         }
     }
+    return INVALID_INDEX;
 }
 
 void
@@ -746,10 +752,44 @@ TermBuffer::setRow(index_t index, const uint32_t *data, const char *str, unsigne
         ptr += 6;
     }
 
+    Tsq::GraphemeWalk tbf(m_term->unicoding(), row.str);
+    column_t size = 0;
+    while (tbf.next())
+        ++size;
+
+    row.size = size;
+
     if (m_term->searching())
         searchRow(row);
 
-    updateRow(row, index);
+    updateRow(row);
+}
+
+bool
+TermBuffer::patchRow(index_t index, const uint32_t *data, const char *str, unsigned len)
+{
+    if (index >= m_size)
+        return true;
+
+    const CellRow &row = m_rows[index & m_capmask];
+    Tsq::RowDiff diff = { data[4], data[5], data[3], data[6], data[7], len };
+
+    std::vector<uint32_t> base;
+    base.reserve(6 * row.ranges.size());
+    for (const auto &range: row.ranges)
+        base.insert(base.end(), { range.start, range.end, (uint32_t)range.flags,
+                    range.fg, range.bg, range.link });
+
+    std::vector<uint32_t> words = { data[0], data[1], 0 };
+    std::string result;
+
+    if (!Tsq::patchRow(base, row.str, data[2], diff, data + 8, str, words, result))
+        return false;
+
+    words[2] = (words.size() - 3) / 6;
+
+    setRow(index, words.data(), result.data(), result.size(), true);
+    return true;
 }
 
 void
@@ -1357,21 +1397,20 @@ TermBuffer::endUpdate()
             m_str.append(cur.str);
         }
 
-        std::smatch match;
-        auto i = str->begin() + pos, j = str->end();
         auto k = m_breaks.cbegin(), l = m_breaks.cend();
         unsigned base = 0;
+        size_t start, end;
 
-        while (std::regex_search(i, j, match, s_urlre))
+        while (UrlScan::find(*str, pos, start, end))
         {
             Region *r;
             r = new Region(Tsqt::RegionLink, this, m_parent->nextSemanticId());
             r->flags = Tsq::HasStart|Tsq::HasEnd|Tsqt::Updating|Tsqt::Inline;
-            r->attributes[g_attr_CONTENT_URI] = QString::fromStdString(match.str());
+            r->attributes[g_attr_CONTENT_URI] =
+                QString::fromUtf8(str->data() + start, end - start);
             handleContentRegion(r);
 
-            pos += match.position();
-            i += match.position();
+            pos = start;
             while (k != l && pos >= *k) {
                 ++index;
                 base = *k++;
@@ -1379,8 +1418,7 @@ TermBuffer::endUpdate()
             r->startRow = index;
             r->startCol = xByPtr(index, pos - base);
 
-            pos += match.length();
-            i += match.length();
+            pos = end;
             while (k != l && pos >= *k) {
                 ++index;
                 base = *k++;
@@ -54,7 +54,7 @@ private:
     CellRow& row(size_t i);
 
     Tsqt::CellFlags regionFlags(index_t i, column_t pos) const;
-    void updateRow(CellRow &row, index_t i);
+    void updateRow(CellRow &row);
     bool searchRow(CellRow &row);
 
     void deleteRegion(Region *region, bool update);
@@ -85,12 +85,14 @@ public:
     inline bool noScrollback() const { return m_noScrollback; }
 
     inline const CellRow& row(size_t i) const { return m_rows[(m_origin + i) & m_capmask]; }
+    void expandRow(size_t i, std::vector<Cell> &cells) const;
     void setRow(index_t i, const uint32_t *data, const char *str, unsigned len, bool pushed);
+    bool patchRow(index_t i, const uint32_t *data, const char *str, unsigned len);
     void setRegion(const uint32_t *data, AttributeMap &attributes);
 
     void updateRows(size_t start, size_t end, RegionList *regionret);
     index_t searchRows(size_t start, size_t end);
-    void fetchRows(size_t start, size_t end);
+    index_t fetchRows(size_t start, size_t end);
 
     Cell cellByPos(size_t idx, column_t pos) const;
     Cell cellByX(size_t idx, int x) const;
@@ -8,6 +8,7 @@
 #include "selection.h"
 #include "term.h"
 #include "overlay.h"
+#include "os/time.h"
 
 #define NBUFFERS 3
 
@@ -30,10 +31,7 @@ TermBuffers::TermBuffers(TermInstance *term) :
         for (int i = 0; i < 128; ++i)
             separatorRow.str.append("\xE2\x94\x81""\xE2\x94\x81", 6);
 
-        Cell &cell = separatorRow.cells.emplace_back();
-        cell.flags = Tsqt::PaintU2500;
-        cell.endptr = separatorRow.str.size();
-        cell.cellwidth = 256;
+        separatorRow.size = 256;
     }
 
     recalculateSizes();
@@ -143,6 +141,27 @@ TermBuffers::row(size_t i) const
     return ptr->row(i - ptr->m_lower);
 }
 
+void
+TermBuffers::rowCells(size_t i, std::vector<Cell> &cells) const
+{
+    int b;
+
+    cells.clear();
+
+    if (m_overlay) {
+        const auto &cref = m_overlay->row(i).cells;
+        cells.assign(cref.begin(), cref.end());
+        return;
+    }
+
+    for (b = 0; b < NBUFFERS - 1; ++b)
+        if (i < m_buffers[b].m_upper)
+            break;
+
+    const auto *ptr = m_buffers + b;
+    ptr->expandRow(i - ptr->m_lower, cells);
+}
+
 const CellRow &
 TermBuffers::safeRow(size_t i) const
 {
@@ -158,6 +177,12 @@ TermBuffers::setRow(index_t i, const uint32_t *data, const char *str, unsigned l
     }
 
     if (!pushed) {
+        if (m_fetchSent && i == m_fetchTimedRow && bufid == m_fetchTimedBuf) {
+            // Smooth the round trip over several requests
+            int rtt = osMonotime() - m_fetchSent;
+            m_fetchRtt = (3 * m_fetchRtt + rtt) / 4;
+            m_fetchSent = 0;
+        }
         if (i == m_fetchNext)
             emit fetchFetchRow();
         if (m_term->searching())
@@ -165,6 +190,13 @@ TermBuffers::setRow(index_t i, const uint32_t *data, const char *str, unsigned l
     }
 }
 
+bool
+TermBuffers::patchRow(index_t i, const uint32_t *data, const char *str, unsigned len)
+{
+    uint8_t bufid = (data[0] & 0xff) * 2;
+    return bufid >= NBUFFERS || m_buffers[bufid].patchRow(i, data, str, len);
+}
+
 void
 TermBuffers::setRegion(const uint32_t *data, AttributeMap &attributes)
 {
@@ -221,7 +253,45 @@ TermBuffers::searchRows(size_t start, size_t end)
 }
 
 void
-TermBuffers::fetchRows(size_t start, size_t end)
+TermBuffers::remoteTarget(size_t idx, uint8_t &bufid, index_t &row)
+{
+    const TermBuffer *buf = bufferAt(idx);
+    bufid = buf->m_bufid;
+    row = buf->m_origin + (idx - buf->m_lower);
+}
+
+index_t
+TermBuffers::remoteRow(uint8_t bufid, index_t row) const
+{
+    int b = bufid * 2;
+    if (b > m_activeBuffer || row == INVALID_INDEX)
+        return INVALID_INDEX;
+
+    const TermBuffer &buf = m_buffers[b];
+    if (row < buf.m_origin || row - buf.m_origin >= buf.size())
+        return INVALID_INDEX;
+
+    return origin() + buf.m_lower + (row - buf.m_origin);
+}
+
+index_t
+TermBuffers::remoteResume(uint8_t bufid, index_t next, bool up) const
+{
+    int b = bufid * 2;
+    if (b > m_activeBuffer)
+        return INVALID_INDEX;
+    if (next != INVALID_INDEX)
+        return remoteRow(bufid, next);
+
+    // The server reached the edge of its buffer, carry on past it
+    const TermBuffer &buf = m_buffers[b];
+    if (up)
+        return buf.m_lower ? origin() + buf.m_lower - 1 : INVALID_INDEX;
+    return origin() + buf.m_upper;
+}
+
+void
+TermBuffers::fetchRows(size_t start, size_t end, bool timed)
 {
     if (end > m_size)
         end = m_size;
@@ -229,7 +299,19 @@ TermBuffers::fetchRows(size_t start, size_t end)
     for (int b = 0; start < end; ++b) {
         if (start < m_buffers[b].m_upper) {
             size_t bound = (end < m_buffers[b].m_upper) ? end : m_buffers[b].m_upper;
-            m_buffers[b].fetchRows(start - m_buffers[b].m_lower, bound - m_buffers[b].m_lower);
+            index_t row = m_buffers[b].fetchRows(start - m_buffers[b].m_lower,
+                                                 bound - m_buffers[b].m_lower);
+
+            // Time the first row of one request at a time
+            if (timed && row != INVALID_INDEX) {
+                int64_t now = osMonotime();
+                // A reset may have swallowed the reply being timed
+                if (!m_fetchSent || now - m_fetchSent > 8 * m_fetchRtt) {
+                    m_fetchSent = now;
+                    m_fetchTimedRow = row;
+                    m_fetchTimedBuf = b;
+                }
+            }
             start = bound;
         }
     }
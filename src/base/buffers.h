@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "app/config.h"
 #include "buffer.h"
 #include "overlay.h"
 
@@ -30,6 +31,12 @@ private:
     index_t m_fetchPos = 0;
     index_t m_fetchNext = INVALID_INDEX;
 
+    // round trip estimate for viewport fetches
+    int64_t m_fetchSent = 0;
+    index_t m_fetchTimedRow = INVALID_INDEX;
+    int m_fetchTimedBuf = 0;
+    int m_fetchRtt = FETCH_RTT_INITIAL;
+
     void recalculateSizes();
 
 signals:
@@ -39,6 +46,7 @@ signals:
     void regionChanged();
 
     void fetchScanRow(index_t row);
+    void fetchSearchRows(unsigned bufid, index_t next, index_t row);
     void fetchFetchRow();
     void fetchPosChanged();
 
@@ -61,6 +69,7 @@ public:
     inline bool noScrollback() const { return m_buffers->noScrollback(); }
     inline index_t fetchPos() const { return m_fetchPos; }
     inline index_t fetchNext() const { return m_fetchNext; }
+    inline int fetchRtt() const { return m_fetchRtt; }
     inline TermBuffer* buffer0() { return m_buffers; }
     inline bool selectionActive() const { return m_selectionActive; }
 
@@ -71,12 +80,20 @@ public:
 
     const CellRow& row(size_t i) const;
     const CellRow& safeRow(size_t i) const;
+    void rowCells(size_t i, std::vector<Cell> &cells) const;
     void setRow(index_t i, const uint32_t *data, const char *str, unsigned len, bool pushed);
+    bool patchRow(index_t i, const uint32_t *data, const char *str, unsigned len);
     void setRegion(const uint32_t *data, AttributeMap &attributes);
 
     void updateRows(size_t start, size_t end, RegionList *regionret);
     index_t searchRows(size_t start, size_t end);
-    void fetchRows(size_t start, size_t end);
+    // Only timed fetches feed the round trip estimate
+    void fetchRows(size_t start, size_t end, bool timed = false);
+
+    // Conversions between view offsets and server rows for remote search
+    void remoteTarget(size_t idx, uint8_t &bufid, index_t &row);
+    index_t remoteRow(uint8_t bufid, index_t row) const;
+    index_t remoteResume(uint8_t bufid, index_t next, bool up) const;
 
     Cell cellByPos(size_t idx, column_t pos) const;
     Cell cellByX(size_t idx, int x) const;
@@ -10,7 +10,7 @@
 class CellBuilder final: public Cell
 {
 private:
-    CellRow &row;
+    std::vector<Cell> &cells;
     int startpos;
     int endpos;
     int x;
@@ -18,22 +18,22 @@ private:
     void push();
 
 public:
-    CellBuilder(CellRow &row);
+    CellBuilder(std::vector<Cell> &cells);
 
     void visit(const CellAttributes &a, bool visible, int pos, int startp, int endp);
     void finish();
 };
 
 inline
-CellBuilder::CellBuilder(CellRow &r) :
-    row(r), startpos(-1), x(0)
+CellBuilder::CellBuilder(std::vector<Cell> &c) :
+    cells(c), startpos(-1), x(0)
 {}
 
 inline void
 CellBuilder::push()
 {
     cellwidth = (endpos - startpos + 1) * (1 + !!(flags & Tsq::DblWidthChar));
-    row.cells.emplace_back(*this);
+    cells.emplace_back(*this);
 }
 
 inline void
@@ -78,6 +78,10 @@ struct DisplayCell: CellAttributes
     DisplayCell(const CellAttributes &a);
 };
 
+//
+// Buffer rows hold only their text and ranges, cells are expanded
+// on display by TermBuffer::expandRow. Overlay rows fill in cells directly
+//
 struct CellRow
 {
     std::string str;
@@ -86,6 +90,7 @@ struct CellRow
     Tsq::LineFlags flags;
     uint32_t size;
     int32_t modtime;
+    uint32_t revision;
     uint32_t regionState;
     uint32_t matchStart;
     uint32_t matchEnd;
@@ -94,6 +99,7 @@ struct CellRow
         flags(0),
         size(0),
         modtime(INVALID_MODTIME),
+        revision(0),
         regionState(0)
         {}
 
@@ -11,6 +11,7 @@
 #include "listener.h"
 #include "term.h"
 #include "connectstatus.h"
+#include "wirereader.h"
 #include "settings/connect.h"
 #include "settings/state.h"
 #include "os/dir.h"
@@ -21,10 +22,12 @@
 #include "lib/handshake.h"
 #include "lib/raw.h"
 #include "lib/term.h"
+#include "lib/zraw.h"
 #include "lib/trstr.h"
 #include "config.h"
 
 #include <QSocketNotifier>
+#include <QThread>
 #include <unistd.h>
 
 #define TR_ERROR1 TL("error", "The %1 executable was not found on the PATH")
@@ -44,6 +47,7 @@ ServerConnection::ServerConnection(ConnectSettings *conninfo) :
 ServerConnection::~ServerConnection()
 {
     // m_conninfo handled in ~ServerInstance()
+    stopWire();
     if (m_fd != -1)
         close(m_fd);
 
@@ -51,9 +55,22 @@ ServerConnection::~ServerConnection()
     delete m_handshake;
 }
 
+void
+ServerConnection::stopWire()
+{
+    if (m_wire) {
+        emit sigWireQuit();
+        m_wireThread->wait();
+        delete m_wire;
+        m_wire = nullptr;
+    }
+}
+
 inline void
 ServerConnection::closefd()
 {
+    stopWire();
+
     if (m_fd != -1) {
         delete m_readNotifier;
         delete m_writeNotifier;
@@ -134,6 +151,7 @@ ServerConnection::start(QWidget *parent)
         m_independent = true;
         m_pty = m_conninfo->pty();
         m_raw = m_conninfo->raw();
+        m_compress = m_conninfo->compress();
         m_keepalive = m_conninfo->keepalive();
 
         m_handshake = new Tsq::ClientHandshake(g_listener->id().buf, false);
@@ -174,6 +192,10 @@ ServerConnection::handleHandshakeHelper(const char *buf, size_t len)
             if (m_handshake->protocolVersion != TSQ_PROTOCOL_VERSION) {
                 protocolType = TSQ_PROTOCOL_REJECT;
                 clientVersion = TSQ_STATUS_PROTOCOL_MISMATCH;
+            } else if (m_raw && m_compress &&
+                       m_handshake->serverVersion >= SERVER_VERSION_ZLIB) {
+                protocolType = TSQ_PROTOCOL_RAW_ZLIB;
+                m_machine = new Tsq::ZlibProtocol(this);
             } else if (m_raw) {
                 protocolType = TSQ_PROTOCOL_RAW;
                 m_machine = new Tsq::RawProtocol(this);
@@ -199,7 +221,7 @@ ServerConnection::handleHandshakeHelper(const char *buf, size_t len)
                 m_dialog->deleteLater();
                 m_dialog = nullptr;
             }
-            connect(m_readNotifier, SIGNAL(activated(int)), SLOT(handleConnection(int)));
+            startWire(protocolType);
             m_conninfo->setActive(this);
             return;
         }
@@ -247,14 +269,61 @@ ServerConnection::handleHandshake(int fd)
 }
 
 void
-ServerConnection::handleConnection(int fd)
+ServerConnection::startWire(int protocolType)
 {
+    // Our own machine is used for sending only from here on
+    m_readNotifier->setEnabled(false);
+    m_readNotifier->deleteLater();
+    m_readNotifier = nullptr;
+
+    m_wireThread = new QThread(this);
+    m_wire = new WireReader(m_wireThread, m_fd, protocolType);
+    m_wire->moveToThread(m_wireThread);
+    connect(m_wireThread, &QThread::started, m_wire, &WireReader::start);
+    connect(this, &ServerConnection::sigWireQuit, m_wire, &WireReader::quit);
+    connect(m_wire, &WireReader::batchReady, this, &ServerConnection::handleBatch);
+    m_wireThread->start();
+}
+
+void
+ServerConnection::handleBatch()
+{
+    WireBatch batch;
+    WireStatus status;
+    int errnum;
+    QString message;
+
+    if (!m_wire)
+        return;
+
+    status = m_wire->takeBatch(batch, errnum, message);
+
     try {
-        m_machine->connRead(fd);
-        m_idleCount = 0;
+        for (const auto &msg: batch) {
+            protocolCallback(msg.command, msg.body.size(), msg.body.data());
+            // Stop dispatching if a command closed the connection
+            if (!m_wire)
+                return;
+        }
     } catch (const std::exception &e) {
         stop();
         reportConnectionFailed(TR_TASKSTAT4 + e.what());
+        return;
+    }
+
+    if (!batch.empty())
+        m_idleCount = 0;
+
+    switch (status) {
+    case WireEof:
+        eofCallback(errnum);
+        break;
+    case WireFailed:
+        stop();
+        reportConnectionFailed(TR_TASKSTAT4 + message);
+        break;
+    default:
+        break;
     }
 }
 
@@ -14,10 +14,12 @@
 
 QT_BEGIN_NAMESPACE
 class QSocketNotifier;
+class QThread;
 class QWidget;
 QT_END_NAMESPACE
 namespace Tsq { class ClientHandshake; }
 class ConnectStatusDialog;
+class WireReader;
 
 class ServerConnection final: public ServerInstance, public Tsq::ProtocolCallback
 {
@@ -32,6 +34,8 @@ private:
 
     QSocketNotifier *m_readNotifier = nullptr;
     QSocketNotifier *m_writeNotifier = nullptr;
+    QThread *m_wireThread = nullptr;
+    WireReader *m_wire = nullptr;
     int m_fd = -1;
     int m_pid = 0;
     int64_t m_timestamp = 0;
@@ -41,6 +45,7 @@ private:
     bool m_independent = false;
     bool m_pty = false;
     bool m_raw = true;
+    bool m_compress = false;
     bool m_announced = false;
 
     bool m_dialogShown = false;
@@ -57,12 +62,14 @@ private:
     QMetaObject::Connection m_mocActivated;
 
     void closefd();
+    void startWire(int protocolType);
+    void stopWire();
     void reportConnectionFailed(const QString &message);
     void handleHandshakeHelper(const char *buf, size_t len);
 
 private slots:
     void handleHandshake(int fd);
-    void handleConnection(int fd);
+    void handleBatch();
     void handleWrite(int fd);
 
     void handleDialogDestroyed();
@@ -73,6 +80,7 @@ protected:
 
 signals:
     void connectionFailed();
+    void sigWireQuit();
 
 public:
     ServerConnection(ConnectSettings *conninfo);
@@ -131,8 +139,10 @@ private:
     void wireTermCursorMoved(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
     void wireTermMouseMoved(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
     void wireTermImageContent(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
+    void wireTermSearchRows(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
     void wireTermBellRang(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
     void wireTermRowChanged(TermInstance *term, Tsq::ProtocolUnmarshaler &unm, bool pushed);
+    void wireTermRowPatched(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
     void wireTermRegionChanged(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
     void wireTermDirectoryChanged(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
     void wireTermFileChanged(TermInstance *term, Tsq::ProtocolUnmarshaler &unm);
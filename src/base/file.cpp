@@ -13,6 +13,7 @@
 
 TermDirectory::TermDirectory()
 {
+    limit = offset = total = 0;
     overlimit = false;
     iserror = false;
 }
@@ -21,6 +22,7 @@ TermDirectory::TermDirectory(Tsq::ProtocolUnmarshaler *unm)
 {
     now = unm->parseNumber64();
     name = QString::fromStdString(unm->parseString());
+    limit = offset = total = 0;
     overlimit = false;
     iserror = false;
 
@@ -35,6 +37,15 @@ TermDirectory::TermDirectory(Tsq::ProtocolUnmarshaler *unm)
             overlimit = true;
             iserror = true;
         }
+        else if (key == TSQ_ATTR_FILE_OFFSET) {
+            offset = QString::fromStdString(unm->parseString()).toUInt();
+        }
+        else if (key == TSQ_ATTR_FILE_TOTAL) {
+            total = QString::fromStdString(unm->parseString()).toUInt();
+        }
+        else if (key == TSQ_ATTR_FILE_LIMIT) {
+            limit = QString::fromStdString(unm->parseString()).toUInt();
+        }
         else if (key == TSQ_ATTR_FILE_ERROR) {
             error = QString::fromStdString(unm->parseString());
             iserror = true;
@@ -17,6 +17,8 @@ struct TermDirectory
     QString error;
     uint64_t now;
     uint32_t limit;
+    // Large directories are sent one page at a time
+    uint32_t offset, total;
     bool overlimit;
     bool iserror;
 
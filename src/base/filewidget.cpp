@@ -42,6 +42,9 @@
 #define TR_TEXT4 TL("window-text", \
     "<a href='#e'>Edit profile %1</a> to make permanent changes")
 #define TR_TEXT5 TL("window-text", "Directory error") + A(": ")
+#define TR_TEXT6 TL("window-text", "Showing entries %1 to %2 of %3")
+#define TR_TEXT7 TL("window-text", "<a href='#p'>Previous page</a>")
+#define TR_TEXT8 TL("window-text", "<a href='#n'>Next page</a>")
 
 FileWidget::FileWidget(TermManager *manager) :
     SearchableWidget(manager),
@@ -54,6 +57,12 @@ FileWidget::FileWidget(TermManager *manager) :
     m_msgLabel->setTextFormat(Qt::RichText);
     m_msgLabel->setContextMenuPolicy(Qt::NoContextMenu);
 
+    m_pageLabel = new QLabel;
+    m_pageLabel->setAlignment(Qt::AlignCenter);
+    m_pageLabel->setTextFormat(Qt::RichText);
+    m_pageLabel->setContextMenuPolicy(Qt::NoContextMenu);
+    m_pageLabel->setVisible(false);
+
     m_overrideFile = new TermFile;
     m_nameitem = new FileNameItem(this);
     m_model = new FileModel(manager, m_nameitem, this);
@@ -85,6 +94,7 @@ FileWidget::FileWidget(TermManager *manager) :
     mainLayout->setContentsMargins(g_mtmargins);
     mainLayout->setSpacing(0);
     mainLayout->addWidget(m_stack, 1);
+    mainLayout->addWidget(m_pageLabel);
     mainLayout->addWidget(m_banner);
     mainLayout->addWidget(m_bar);
     setLayout(mainLayout);
@@ -111,6 +121,9 @@ FileWidget::FileWidget(TermManager *manager) :
     connect(m_msgLabel,
             SIGNAL(linkActivated(const QString&)),
             SLOT(handleLinkActivated(const QString&)));
+    connect(m_pageLabel,
+            SIGNAL(linkActivated(const QString&)),
+            SLOT(handleLinkActivated(const QString&)));
 }
 
 FileWidget::~FileWidget()
@@ -144,10 +157,39 @@ FileWidget::updateFormat()
     }
 }
 
+void
+FileWidget::updatePage(const TermDirectory *dir)
+{
+    if (!dir || dir->iserror || !dir->total || !dir->limit) {
+        m_pageLabel->setVisible(false);
+        return;
+    }
+
+    uint32_t end = qMin(dir->offset + dir->limit, dir->total);
+
+    QStringList msglist;
+    msglist.append(TR_TEXT6.arg(dir->offset + 1).arg(end).arg(dir->total));
+
+    // Links carry the offset of the page and the directory it belongs to
+    if (dir->offset) {
+        uint32_t prev = dir->offset > dir->limit ? dir->offset - dir->limit : 0;
+        m_linkPrev = QString::number(prev) + ':' + dir->name;
+        msglist.append(TR_TEXT7);
+    }
+    if (end < dir->total) {
+        m_linkNext = QString::number(end) + ':' + dir->name;
+        msglist.append(TR_TEXT8);
+    }
+
+    m_pageLabel->setText(msglist.join(A(" ")));
+    m_pageLabel->setVisible(true);
+}
+
 void
 FileWidget::updateDirectory(const TermDirectory *dir)
 {
     m_banner->setDirectory(dir);
+    updatePage(dir);
 
     if (dir == nullptr) {
         m_msgLabel->setText(TR_TEXT1);
@@ -212,6 +254,12 @@ FileWidget::handleLinkActivated(const QString &link)
     else if (link == A("#e")) {
         m_manager->actionEditProfile(m_linkProfile);
     }
+    else if (link == A("#p")) {
+        g_listener->pushTermAttribute(m_term, g_attr_PREF_FILEPAGE, m_linkPrev);
+    }
+    else if (link == A("#n")) {
+        g_listener->pushTermAttribute(m_term, g_attr_PREF_FILEPAGE, m_linkNext);
+    }
 }
 
 void
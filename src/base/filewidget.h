@@ -49,6 +49,7 @@ private:
 
     QStackedWidget *m_stack;
     QLabel *m_msgLabel;
+    QLabel *m_pageLabel;
     FileView *m_longView;
     FileListing *m_shortView;
     FileBanner *m_banner;
@@ -57,6 +58,7 @@ private:
     int m_formatOverride = 0;
 
     QString m_linkProfile, m_linkLimit;
+    QString m_linkPrev, m_linkNext;
 
     QFont m_font;
     QRect m_dragBounds;
@@ -66,6 +68,7 @@ private:
 
     void selectItem(int index, const TermFile *file);
     void updateDirectory(const TermDirectory *dir);
+    void updatePage(const TermDirectory *dir);
     void updateFormat();
     void updateSize(const QSize &size);
 
@@ -12,6 +12,7 @@
 #include "thumbicon.h"
 #include "u2500.h"
 #include "lib/grapheme.h"
+#include "app/config.h"
 
 #include <QFontDatabase>
 #include <QSvgRenderer>
@@ -45,10 +46,24 @@ FontBase::getCellSize(const QFont &font)
     return result;
 }
 
+qreal
+FontBase::textWidth(const QString &text) const
+{
+    auto i = m_widths.constFind(text);
+    if (i != m_widths.cend())
+        return *i;
+
+    if (m_widths.size() >= WIDTH_CACHE_MAX)
+        m_widths.clear();
+
+    return m_widths[text] = m_metrics.width(text);
+}
+
 void
 FontBase::calculateCellSize(const QFont &font)
 {
     m_metrics = QFontMetricsF(font);
+    m_widths.clear();
 
     /* Need to handle fixed-width fonts that have *fractional* width */
     m_cellSize.setWidth(m_metrics.width(s_refChar) / REPS);
@@ -98,6 +113,9 @@ DisplayIterator::setDisplayFont(const QFont &font)
 {
     calculateCellSize(m_font = font);
     m_fontWeight = font.weight();
+    m_rowCells.clear();
+    m_lineRevisions.clear();
+    m_lineDamage.clear();
 }
 
 void
@@ -144,7 +162,7 @@ DisplayIterator::recomposeCell(DisplayCell &dc, unsigned clusters,
         first.text = QString::fromStdString(first.substr);
         qreal w = charwidth * splitpos;
         first.rect.setWidth(w);
-        qreal t = m_metrics.width(first.text);
+        qreal t = textWidth(first.text);
 
         if (qFabs(w - t) < 1.0)
             m_displayCells.emplace_back(std::move(first));
@@ -157,7 +175,7 @@ DisplayIterator::recomposeCell(DisplayCell &dc, unsigned clusters,
         dc.point.rx() += w;
         w = charwidth * clusters;
         dc.rect.setWidth(w);
-        t = m_metrics.width(dc.text);
+        t = textWidth(dc.text);
 
         if (qFabs(w - t) < 1.0)
             m_displayCells.emplace_back(std::move(dc));
@@ -166,66 +184,115 @@ DisplayIterator::recomposeCell(DisplayCell &dc, unsigned clusters,
     }
 }
 
+void
+DisplayIterator::calculateRow(const CellRow &row, const std::vector<Cell> &cells)
+{
+    qreal x, w, t;
+
+    for (const auto &cell: cells)
+    {
+        x = cell.cellx * m_cellSize.width();
+        w = cell.cellwidth * m_cellSize.width();
+
+        DisplayCell dc(cell);
+        dc.substr = row.str.substr(cell.startptr, cell.endptr - cell.startptr);
+        dc.rect.setRect(x, 0.0, w, m_cellSize.height());
+        dc.lineFlags = row.flags & Tsq::DblLineMask;
+
+        if (dc.flags & Tsq::EmojiChar) {
+            emojifyCell(dc);
+            continue;
+        }
+
+        dc.point = QPointF(x, m_ascent);
+        dc.text = QString::fromStdString(dc.substr);
+        t = textWidth(dc.text);
+
+        if (qFabs(w - t) < 1.0) {
+            m_displayCells.emplace_back(std::move(dc));
+        } else {
+            w = m_cellSize.width();
+            unsigned clusters = cell.cellwidth;
+
+            if (dc.flags & Tsq::DblWidthChar) {
+                w *= 2;
+                clusters /= 2;
+            }
+            if (dc.flags & Tsq::Underline) {
+                // Handle the underline with a separate cell of spaces
+                DisplayCell ul(dc);
+                ul.flags &= ~Tsqt::VisibleBg;
+                ul.text = L(" ").repeated(cell.cellwidth);
+                m_displayCells.emplace_back(std::move(ul));
+                dc.flags &= ~(Tsqt::CellFlags)Tsq::Underline;
+            }
+
+            recomposeCell(dc, clusters, t, w);
+        }
+    }
+}
+
 void
 DisplayIterator::calculateCells(TermViewport *viewport, bool doMouse)
 {
     m_displayCells.clear();
+    m_lineStarts.clear();
 
     size_t cur = viewport->m_offset;
     size_t r = viewport->m_buffers->size() - cur;
     size_t h = viewport->m_bounds.height();
     size_t end = cur + (r < h ? r : h);
-    qreal x, y, w, t;
+    size_t line = 0;
+    qreal x, y, w;
 
     // Content
-    for (y = 0.0; cur < end; ++cur)
+    for (y = 0.0; cur < end; ++cur, ++line)
     {
         const CellRow &row = viewport->m_buffers->row(cur);
-        for (const auto &cell: row.cells)
-        {
-            x = cell.cellx * m_cellSize.width();
-            w = cell.cellwidth * m_cellSize.width();
+        size_t first = m_displayCells.size();
+        auto i = m_rowCells.find(row.revision);
 
-            DisplayCell dc(cell);
-            dc.substr = row.str.substr(cell.startptr, cell.endptr - cell.startptr);
-            dc.rect.setRect(x, y, w, m_cellSize.height());
-            dc.lineFlags = row.flags & Tsq::DblLineMask;
-
-            if (dc.flags & Tsq::EmojiChar) {
-                emojifyCell(dc);
-                continue;
-            }
+        if (line == m_lineRevisions.size()) {
+            m_lineRevisions.push_back(0);
+            m_lineDamage.push_back(true);
+        }
+        if (!row.revision || row.revision != m_lineRevisions[line]) {
+            m_lineRevisions[line] = row.revision;
+            m_lineDamage[line] = true;
+        }
+        m_lineStarts.push_back(first);
 
-            dc.point = QPointF(x, y + m_ascent);
-            dc.text = QString::fromStdString(dc.substr);
-            t = m_metrics.width(dc.text);
+        // Rows keep their revision until relaid out, so scrolled rows hit
+        if (row.revision && i != m_rowCells.end()) {
+            m_displayCells.insert(m_displayCells.end(), i->cbegin(), i->cend());
+            c_rowCells.insert(row.revision, std::move(*i));
+        } else {
+            viewport->m_buffers->rowCells(cur, m_cells);
+            calculateRow(row, m_cells);
+            if (row.revision)
+                c_rowCells.insert(row.revision,
+                                  DisplayCellList(m_displayCells.begin() + first,
+                                                  m_displayCells.end()));
+        }
 
-            if (qFabs(w - t) < 1.0) {
-                m_displayCells.emplace_back(std::move(dc));
-            } else {
-                w = m_cellSize.width();
-                unsigned clusters = cell.cellwidth;
-
-                if (dc.flags & Tsq::DblWidthChar) {
-                    w *= 2;
-                    clusters /= 2;
-                }
-                if (dc.flags & Tsq::Underline) {
-                    // Handle the underline with a separate cell of spaces
-                    DisplayCell ul(dc);
-                    ul.flags &= ~Tsqt::VisibleBg;
-                    ul.text = L(" ").repeated(cell.cellwidth);
-                    m_displayCells.emplace_back(std::move(ul));
-                    dc.flags &= ~(Tsqt::CellFlags)Tsq::Underline;
-                }
-
-                recomposeCell(dc, clusters, t, w);
-            }
+        for (size_t k = first, n = m_displayCells.size(); k < n; ++k) {
+            m_displayCells[k].rect.translate(0.0, y);
+            m_displayCells[k].point.ry() += y;
         }
 
         y += m_cellSize.height();
     }
 
+    // Only rows displayed this time are kept
+    m_rowCells.swap(c_rowCells);
+    c_rowCells.clear();
+
+    m_lineStarts.push_back(m_displayCells.size());
+    for (; line < m_lineRevisions.size(); ++line) {
+        m_lineRevisions[line] = 0;
+        m_lineDamage[line] = true;
+    }
+
     // Cursor
     QPoint cursor = viewport->cursor();
     cur = viewport->m_offset + cursor.y();
@@ -245,7 +312,7 @@ DisplayIterator::calculateCells(TermViewport *viewport, bool doMouse)
         m_cursorCell.rect.setRect(x, y, w, m_cellSize.height());
 
         m_cursorCell.text = QString::fromStdString(m_cursorCell.substr);
-        w -= m_metrics.width(m_cursorCell.text);
+        w -= textWidth(m_cursorCell.text);
         m_cursorCell.point = QPointF(x + w / 2.0, y + m_ascent);
 
         if (cell.flags & Tsq::EmojiChar) {
@@ -7,6 +7,7 @@
 #include "cell.h"
 
 #include <QFontMetricsF>
+#include <QHash>
 #include <QFontInfo>
 #include <QPainter>
 
@@ -27,6 +28,11 @@ protected:
     QFontMetricsF m_metrics;
     qreal m_ascent;
 
+    // Measured widths of cell text, cleared with the font
+    mutable QHash<QString,qreal> m_widths;
+
+    qreal textWidth(const QString &text) const;
+
     void calculateCellSize(const QFont &font);
     void calculateCellSize(const QString &fontStr);
 
@@ -51,11 +57,22 @@ protected:
     DisplayCell m_cursorCell;
     DisplayCell m_mouseCell;
 
+    // Per displayed line: index of its first cell (plus an end marker),
+    // and whether it changed since the damage was last consumed
+    std::vector<size_t> m_lineStarts;
+    std::vector<uint32_t> m_lineRevisions;
+    std::vector<bool> m_lineDamage;
+
     QFont m_font;
     int m_fontWeight;
     // bool m_fontUnderline;
 
 private:
+    // Cells of recently displayed rows, by row revision (y = 0)
+    QHash<uint32_t,DisplayCellList> m_rowCells, c_rowCells;
+    std::vector<Cell> m_cells;
+
+    void calculateRow(const CellRow &row, const std::vector<Cell> &cells);
     void recomposeCell(DisplayCell &dc, unsigned clusters,
                        qreal textwidth, qreal charwidth);
     void emojifyCell(DisplayCell &dc);
@@ -186,6 +186,7 @@ public:
     void pushTermMouseEvent(TermInstance *term, uint64_t flags, int x, int y);
     void pushTermResize(TermInstance *term, QSize size);
     void pushTermFetch(TermInstance *term, index_t start, index_t end, uint8_t bufid);
+    void pushTermSearch(TermInstance *term, uint8_t bufid, index_t start, bool up);
     void pushTermGetImage(TermInstance *term, contentid_t id);
     void pushTermScrollLock(TermInstance *term);
     void pushTermAttribute(TermInstance *term, const QString &key, const QString &value);
@@ -0,0 +1,169 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "scanner.h"
+#include "app/config.h"
+
+#include <QThread>
+#include <algorithm>
+
+ScanController *g_scanner;
+
+//
+// Matcher
+//
+ScanMatcher::ScanMatcher(const TermSearch &search)
+{
+    if (search.type != Tsqt::SingleLinePlainText ||
+        !setLiteral(search.text.toStdString(), !search.matchCase))
+        setRegex(&search.regex);
+}
+
+//
+// Thread worker
+//
+ScanWorker::ScanWorker(ScanController *parent, QThread *thread) :
+    m_parent(parent),
+    m_thread(thread)
+{
+}
+
+void
+ScanWorker::runJob(const ScanJob &job)
+{
+    ScanMatcher matcher(job.search);
+    unsigned count = 0;
+
+    for (const auto &line: job.lines)
+    {
+        if (++count % SCAN_CHECK_INTERVAL == 0 && !m_parent->live(job.id))
+            return;
+
+        index_t found = INVALID_INDEX;
+        size_t pos = 0, start, end;
+
+        for (; matcher.find(line.str, pos, start, end); pos = start + 1)
+        {
+            auto i = std::upper_bound(line.breaks.begin(), line.breaks.end(), start);
+            index_t row = line.row + (i - line.breaks.begin());
+
+            if (job.up) {
+                // Keep the last match at or before the bound
+                if (row > job.bound)
+                    break;
+                found = row;
+            } else if (row >= job.bound) {
+                found = row;
+                break;
+            }
+        }
+
+        if (found != INVALID_INDEX)
+            emit reportMatch(job.id, found);
+    }
+
+    emit reportFinished(job.id);
+}
+
+void
+ScanWorker::run()
+{
+    std::unique_ptr<ScanJob> job;
+
+    while ((job = m_parent->takeJob())) {
+        runJob(*job);
+
+        m_parent->m_lock.lock();
+        m_parent->m_live.erase(job->id);
+        m_parent->m_lock.unlock();
+    }
+}
+
+void
+ScanWorker::quit()
+{
+    m_thread->quit();
+}
+
+//
+// Thread controller
+//
+ScanController::ScanController() :
+    m_thread(new QThread(this)),
+    m_worker(new ScanWorker(this, m_thread))
+{
+    m_worker->moveToThread(m_thread);
+    connect(this, &ScanController::sigRun, m_worker, &ScanWorker::run);
+    connect(this, &ScanController::sigQuit, m_worker, &ScanWorker::quit);
+
+    connect(m_worker, SIGNAL(reportMatch(unsigned,index_t)), SIGNAL(reportMatch(unsigned,index_t)));
+    connect(m_worker, SIGNAL(reportFinished(unsigned)), SIGNAL(reportFinished(unsigned)));
+    m_thread->start();
+}
+
+ScanController::~ScanController()
+{
+    m_lock.lock();
+    m_jobs.clear();
+    m_live.clear();
+    m_lock.unlock();
+
+    emit sigQuit();
+    m_thread->wait();
+    delete m_worker;
+}
+
+bool
+ScanController::live(unsigned id)
+{
+    QMutexLocker locker(&m_lock);
+    return m_live.count(id);
+}
+
+std::unique_ptr<ScanJob>
+ScanController::takeJob()
+{
+    QMutexLocker locker(&m_lock);
+    std::unique_ptr<ScanJob> result;
+
+    if (!m_jobs.empty()) {
+        result = std::move(m_jobs.front());
+        m_jobs.pop_front();
+    }
+    return result;
+}
+
+void
+ScanController::startScan(ScanJob *job, unsigned &id)
+{
+    if (++m_nextId == INVALID_SCAN_ID)
+        ++m_nextId;
+
+    id = job->id = m_nextId;
+
+    m_lock.lock();
+    m_live.insert(id);
+    m_jobs.emplace_back(job);
+    m_lock.unlock();
+
+    emit sigRun();
+}
+
+void
+ScanController::stopScan(unsigned &id)
+{
+    if (id != INVALID_SCAN_ID) {
+        m_lock.lock();
+        m_live.erase(id);
+        for (auto i = m_jobs.begin(); i != m_jobs.end(); ++i)
+            if ((*i)->id == id) {
+                m_jobs.erase(i);
+                break;
+            }
+        m_lock.unlock();
+
+        id = INVALID_SCAN_ID;
+    }
+}
@@ -0,0 +1,114 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "search.h"
+#include "lib/types.h"
+#include "lib/textmatch.h"
+
+#include <QObject>
+#include <QMutex>
+#include <deque>
+#include <memory>
+#include <unordered_set>
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
+class ScanController;
+
+#define INVALID_SCAN_ID 0
+
+struct ScanLine {
+    // First row of the logical line
+    index_t row;
+    std::string str;
+    // Byte offsets at which each continuation row begins
+    std::vector<size_t> breaks;
+};
+
+struct ScanJob {
+    unsigned id;
+    bool up;
+    // Matches beyond this row, in the scan direction's past, are skipped
+    index_t bound;
+    TermSearch search;
+    // In scan order
+    std::vector<ScanLine> lines;
+};
+
+//
+// Matcher for a search, run over joined logical lines
+//
+class ScanMatcher final: public Tsq::TextMatcher
+{
+public:
+    ScanMatcher(const TermSearch &search);
+};
+
+//
+// Thread worker
+//
+class ScanWorker final: public QObject
+{
+    Q_OBJECT
+
+private:
+    ScanController *m_parent;
+    QThread *m_thread;
+
+    void runJob(const ScanJob &job);
+
+signals:
+    void reportMatch(unsigned id, index_t row);
+    void reportFinished(unsigned id);
+
+public slots:
+    void run();
+    void quit();
+
+public:
+    ScanWorker(ScanController *parent, QThread *thread);
+};
+
+//
+// Thread controller
+//
+class ScanController final: public QObject
+{
+    Q_OBJECT
+
+    friend class ScanWorker;
+
+private:
+    QThread *m_thread;
+    ScanWorker *m_worker;
+
+    QMutex m_lock;
+    std::deque<std::unique_ptr<ScanJob>> m_jobs;
+    std::unordered_set<unsigned> m_live;
+    unsigned m_nextId = INVALID_SCAN_ID;
+
+    bool live(unsigned id);
+    std::unique_ptr<ScanJob> takeJob();
+
+signals:
+    void reportMatch(unsigned id, index_t row);
+    void reportFinished(unsigned id);
+
+    // Internal worker signals
+    void sigRun();
+    void sigQuit();
+
+public:
+    ScanController();
+    ~ScanController();
+
+    // Takes ownership of job
+    void startScan(ScanJob *job, unsigned &id);
+    void stopScan(unsigned &id);
+};
+
+extern ScanController *g_scanner;
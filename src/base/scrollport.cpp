@@ -13,12 +13,14 @@
 #include "screen.h"
 #include "listener.h"
 #include "scrolltimer.h"
+#include "scanner.h"
 #include "server.h"
 #include "selection.h"
 #include "filetracker.h"
 #include "settings/global.h"
 #include "settings/profile.h"
 #include "settings/notedialog.h"
+#include "os/time.h"
 
 #include <QKeyEvent>
 
@@ -44,6 +46,9 @@ TermScrollport::TermScrollport(TermManager *manager, TermInstance *term, QObject
     connect(m_buffers, SIGNAL(bufferChanged()), SLOT(handleBufferChanged()));
     connect(m_buffers, SIGNAL(bufferReset()), SLOT(handleBufferReset()));
     connect(m_buffers, SIGNAL(fetchScanRow(index_t)), SLOT(handleRowFetched(index_t)));
+    connect(m_buffers, SIGNAL(fetchSearchRows(unsigned,index_t,index_t)), SLOT(handleSearchFetched(unsigned,index_t,index_t)));
+    connect(g_scanner, SIGNAL(reportMatch(unsigned,index_t)), SLOT(handleScanMatch(unsigned,index_t)));
+    connect(g_scanner, SIGNAL(reportFinished(unsigned)), SLOT(handleScanFinished(unsigned)));
     connect(m_buffers, SIGNAL(promptDeleted(regionid_t)), SLOT(removeActivePrompt(regionid_t)));
     connect(m_term, SIGNAL(flagsChanged(Tsq::TermFlags)), SLOT(handleFlagsChanged(Tsq::TermFlags)));
     connect(m_term, SIGNAL(processChanged(const QString&)), SLOT(handleProcessChanged(const QString&)));
@@ -93,6 +98,7 @@ TermScrollport::handleBufferChanged()
 void
 TermScrollport::handleBufferReset()
 {
+    m_prefetchLo = m_prefetchHi = 0;
     m_locked = false;
     m_lockedRow = INVALID_INDEX;
     moveToEnd();
@@ -315,6 +321,7 @@ TermScrollport::startScan(bool up)
 {
     if (m_term->searching())
     {
+        g_scanner->stopScan(m_scanId);
         m_scanUp = up;
         m_scanFetching = false;
 
@@ -334,6 +341,8 @@ TermScrollport::stopScan()
 {
     m_scanRow = INVALID_INDEX;
     m_scanFetching = false;
+    m_scanRemote = false;
+    g_scanner->stopScan(m_scanId);
 }
 
 inline void
@@ -363,6 +372,79 @@ TermScrollport::scanFetch(size_t offset, size_t size)
     m_buffers->fetchRows(lower, upper);
 }
 
+static inline bool
+isDownloaded(const TermBuffers *buffers, size_t i)
+{
+    return buffers->row(i).flags & Tsqt::Downloaded;
+}
+
+static inline bool
+isContinued(const TermBuffers *buffers, size_t i)
+{
+    return (buffers->row(i).flags & Tsq::Continuation) && isDownloaded(buffers, i);
+}
+
+static void
+appendLine(ScanJob *job, const TermBuffers *buffers, size_t start, size_t end)
+{
+    ScanLine &line = job->lines.emplace_back();
+    line.row = buffers->origin() + start;
+    line.str = buffers->row(start).str;
+
+    while (++start < end) {
+        line.breaks.push_back(line.str.size());
+        line.str.append(buffers->row(start).str);
+    }
+}
+
+size_t
+TermScrollport::scanBatchUp(ScanJob *job, size_t offset)
+{
+    size_t end = offset + 1, size = m_buffers->size();
+    size_t limit = (offset > SCAN_BATCH_SIZE) ? offset - SCAN_BATCH_SIZE : 0;
+
+    // Finish the logical line containing the current row
+    while (end < size && isContinued(m_buffers, end))
+        ++end;
+
+    size_t start = end;
+
+    while (start > limit && isDownloaded(m_buffers, start - 1)) {
+        size_t first = start - 1;
+        while (first > 0 && (m_buffers->row(first).flags & Tsq::Continuation) &&
+               isDownloaded(m_buffers, first - 1))
+            --first;
+
+        appendLine(job, m_buffers, first, start);
+        start = first;
+    }
+
+    return start - 1;
+}
+
+size_t
+TermScrollport::scanBatchDown(ScanJob *job, size_t offset, size_t size)
+{
+    size_t start = offset;
+    size_t limit = offset + SCAN_BATCH_SIZE;
+
+    // Back up to the start of the logical line containing the current row
+    while (start > 0 && (m_buffers->row(start).flags & Tsq::Continuation) &&
+           isDownloaded(m_buffers, start - 1))
+        --start;
+
+    while (start < limit && start < size && isDownloaded(m_buffers, start)) {
+        size_t next = start + 1;
+        while (next < size && isContinued(m_buffers, next))
+            ++next;
+
+        appendLine(job, m_buffers, start, next);
+        start = next;
+    }
+
+    return start;
+}
+
 bool
 TermScrollport::scanCallback()
 {
@@ -380,34 +462,68 @@ TermScrollport::scanCallback()
     size_t offset = m_scanRow - origin;
 
     if ((m_buffers->row(offset).flags & Tsqt::Downloaded) == 0) {
+        if (!m_scanRemote && m_term->server()->version() >= SERVER_VERSION_SEARCH) {
+            // No - let the server search ahead without sending the rows
+            uint8_t bufid;
+            index_t row;
+            m_buffers->remoteTarget(offset, bufid, row);
+            g_listener->pushTermSearch(m_term, bufid, row, m_scanUp);
+            m_scanFetching = true;
+            emit searchStatusChanged(m_searchStatus = TR_TEXT5.arg(m_scanRow));
+            return false;
+        }
         // No - schedule a fetch
         scanFetch(offset, size);
         m_scanFetching = true;
         emit searchStatusChanged(m_searchStatus = TR_TEXT3.arg(m_scanRow));
         return false;
     }
-    else if (m_scanRow == m_buffers->searchRows(offset, offset + 1)) {
-        // Match - stop here
-        m_search.startRow = m_search.endRow = m_scanRow;
-        scrollToRow(m_scanRow, false);
-        m_buffers->activateRegion(&m_search);
-        emit searchStatusChanged(m_searchStatus = TR_TEXT4.arg(m_scanRow));
-        stopScan();
-        return false;
-    }
-    else if (m_scanUp) {
-        // No match - keep searching
-        --m_scanRow;
-    }
-    else {
-        // No match - keep searching
-        ++m_scanRow;
-    }
 
-    if ((m_scanRow % 100) == 0) {
-        emit searchStatusChanged(m_searchStatus = TR_TEXT5.arg(m_scanRow));
+    m_scanRemote = false;
+
+    // Yes - hand the downloaded run of lines to the scanner thread
+    auto *job = new ScanJob;
+    job->up = m_scanUp;
+    job->bound = m_scanRow;
+    job->search = m_term->search();
+
+    if (m_scanUp)
+        m_scanNext = origin + scanBatchUp(job, offset);
+    else
+        m_scanNext = origin + scanBatchDown(job, offset, size);
+
+    g_scanner->startScan(job, m_scanId);
+    emit searchStatusChanged(m_searchStatus = TR_TEXT5.arg(m_scanRow));
+    return false;
+}
+
+void
+TermScrollport::handleScanMatch(unsigned id, index_t row)
+{
+    index_t origin = m_buffers->origin();
+
+    if (id != m_scanId || row < origin || row >= origin + m_buffers->size())
+        return;
+
+    // Match - stop here
+    size_t offset = row - origin;
+    m_buffers->searchRows(offset, offset + 1);
+    m_search.startRow = m_search.endRow = row;
+    scrollToRow(row, false);
+    m_buffers->activateRegion(&m_search);
+    emit searchStatusChanged(m_searchStatus = TR_TEXT4.arg(row));
+    stopScan();
+}
+
+void
+TermScrollport::handleScanFinished(unsigned id)
+{
+    if (id == m_scanId) {
+        // No match - keep searching
+        m_scanId = INVALID_SCAN_ID;
+        m_scanRow = m_scanNext;
+        g_listener->scroll()->setScanTimer(this);
     }
-    return true;
 }
 
 void
@@ -419,6 +535,26 @@ TermScrollport::handleRowFetched(index_t row)
     }
 }
 
+void
+TermScrollport::handleSearchFetched(unsigned bufid, index_t next, index_t row)
+{
+    if (!m_scanFetching || m_scanId != INVALID_SCAN_ID)
+        return;
+
+    m_scanFetching = false;
+    row = m_buffers->remoteRow(bufid, row);
+
+    if (row != INVALID_INDEX) {
+        // Fetch the matching row, the local scan confirms and shows it
+        m_scanRow = row;
+        m_scanRemote = true;
+    } else {
+        m_scanRow = m_buffers->remoteResume(bufid, next, m_scanUp);
+    }
+
+    g_listener->scroll()->setScanTimer(this);
+}
+
 void
 TermScrollport::handleSearchChanged(bool)
 {
@@ -466,19 +602,75 @@ TermScrollport::searchCallback()
     emit searchUpdate();
 }
 
+void
+TermScrollport::prefetch(size_t lo, size_t hi)
+{
+    index_t origin = m_buffers->origin();
+    index_t alo = origin + lo, ahi = origin + hi;
+
+    // skip rows requested by the last prefetch, which may still be in flight
+    if (alo >= m_prefetchLo && ahi <= m_prefetchHi)
+        return;
+    if (alo < m_prefetchLo && ahi > m_prefetchLo && ahi <= m_prefetchHi)
+        ahi = m_prefetchLo;
+    else if (alo >= m_prefetchLo && alo < m_prefetchHi && ahi > m_prefetchHi)
+        alo = m_prefetchHi;
+
+    m_buffers->fetchRows(alo - origin, ahi - origin);
+
+    // extend the tracked extent while scrolling continues in one direction
+    if (alo == m_prefetchHi) {
+        m_prefetchHi = ahi;
+    } else if (ahi == m_prefetchLo) {
+        m_prefetchLo = alo;
+    } else {
+        m_prefetchLo = alo;
+        m_prefetchHi = ahi;
+    }
+}
+
 void
 TermScrollport::fetchCallback()
 {
+    int64_t now = osMonotime();
+    int64_t elapsed = now - m_fetchTime;
+
+    // estimate scroll velocity from recent offset changes
+    if (elapsed > 0 && elapsed < FETCH_VELOCITY_WINDOW) {
+        int velocity = (m_offset - m_fetchOffset) * 1000 / elapsed;
+        m_fetchVelocity = (m_fetchVelocity + velocity) / 2;
+    } else {
+        m_fetchVelocity = 0;
+    }
+    m_fetchTime = now;
+    m_fetchOffset = m_offset;
+
     // fetch unseen rows if necessary
     if (m_offset < m_screen->offset())
     {
         size_t start = m_offset;
         size_t end = m_offset + height();
-
-        if (end > m_screen->offset())
-            end = m_screen->offset();
-
-        m_buffers->fetchRows(start, end);
+        size_t limit = m_screen->offset();
+
+        if (end > limit)
+            end = limit;
+
+        m_buffers->fetchRows(start, end, true);
+
+        // prefetch the rows that will be reached within two round trips
+        if (m_fetchVelocity) {
+            int64_t speed = (m_fetchVelocity < 0) ? -m_fetchVelocity : m_fetchVelocity;
+            size_t ahead = speed * m_buffers->fetchRtt() / 500;
+            if (ahead < (size_t)height())
+                ahead = height();
+            if (ahead > FETCH_AHEAD_MAX)
+                ahead = FETCH_AHEAD_MAX;
+
+            if (m_fetchVelocity < 0)
+                prefetch(start > ahead ? start - ahead : 0, start);
+            else if (end < limit)
+                prefetch(end, (end + ahead < limit) ? end + ahead : limit);
+        }
     }
 
     // run search if necessary
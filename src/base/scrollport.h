@@ -13,6 +13,7 @@ class QKeyEvent;
 QT_END_NAMESPACE
 class TermManager;
 class TermScreen;
+struct ScanJob;
 
 class TermScrollport final: public TermViewport
 {
@@ -32,6 +33,7 @@ private:
     bool m_searchon = false;
     bool m_scanUp = false;
     bool m_scanFetching = false;
+    bool m_scanRemote = false;
     bool m_selecting = false;
 
     int m_clickPoint = 0;
@@ -45,6 +47,16 @@ private:
     Region m_activePrompt;
     Region m_search;
     index_t m_scanRow = INVALID_INDEX;
+    index_t m_scanNext;
+
+    // scroll velocity in rows/sec, for prefetching
+    int64_t m_fetchTime = 0;
+    int m_fetchOffset = 0;
+    int m_fetchVelocity = 0;
+    // extent of rows already prefetched
+    index_t m_prefetchLo = 0;
+    index_t m_prefetchHi = 0;
+    unsigned m_scanId = 0;
 
     QString m_searchStatus;
     TermUrl m_selectedUrl;
@@ -65,6 +77,8 @@ private:
     void updateRegions();
     void stopScan();
     void scanFetch(size_t offset, size_t size);
+    size_t scanBatchUp(ScanJob *job, size_t offset);
+    size_t scanBatchDown(ScanJob *job, size_t offset, size_t size);
 
 signals:
     void scrollChanged();
@@ -103,6 +117,9 @@ private slots:
     void handleAttributeChanged(const QString &key, const QString &value);
     void handleSearchChanged(bool searching);
     void handleRowFetched(index_t row);
+    void handleScanMatch(unsigned id, index_t row);
+    void handleScanFinished(unsigned id);
+    void handleSearchFetched(unsigned bufid, index_t next, index_t row);
     void removeActivePrompt(regionid_t id);
 
 public:
@@ -178,6 +195,7 @@ public:
     void startScan(bool up);
     bool scanCallback();
     void searchCallback();
+    void prefetch(size_t lo, size_t hi);
     void fetchCallback();
 };
 
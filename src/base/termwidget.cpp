@@ -105,8 +105,8 @@ TermWidget::TermWidget(TermStack *stack, TermScrollport *scrollport,
     connect(m_scrollport, SIGNAL(contextMenuRequest()), SLOT(handleContextMenuRequest()));
     connect(m_stack->manager(), SIGNAL(activeChanged(bool)), SLOT(refocus()));
     connect(m_term, SIGNAL(fontChanged(const QFont&)), SLOT(refont(const QFont&)));
-    connect(m_term, SIGNAL(colorsChanged(QRgb,QRgb)), SLOT(update()));
-    connect(m_term, SIGNAL(paletteChanged()), SLOT(update()));
+    connect(m_term, SIGNAL(colorsChanged(QRgb,QRgb)), SLOT(invalidate()));
+    connect(m_term, SIGNAL(paletteChanged()), SLOT(invalidate()));
     connect(m_term, SIGNAL(ownershipChanged(bool)), SLOT(handleOwnershipChanged(bool)));
     connect(m_term, SIGNAL(peerChanged()), SLOT(handleIndicators()));
     connect(m_term, SIGNAL(alertChanged()), SLOT(handleIndicators()));
@@ -157,6 +157,13 @@ TermWidget::redisplay()
     update();
 }
 
+void
+TermWidget::invalidate()
+{
+    m_damageAll = true;
+    update();
+}
+
 void
 TermWidget::refocus()
 {
@@ -321,6 +328,7 @@ void
 TermWidget::refont(const QFont &font)
 {
     setDisplayFont(font);
+    m_damageAll = true;
 
     qCDebug(lcLayout) << this << "cell size is" << m_cellSize << "ascent is" << m_ascent;
 
@@ -544,6 +552,63 @@ TermWidget::paintBox(QPainter &painter, const DisplayCell &i, CellState &state)
     painter.setPen(savedPen);
 }
 
+void
+TermWidget::paintBacking(const CellState &paintState)
+{
+    qreal dpr = devicePixelRatioF();
+    QSize pixelSize = size() * dpr;
+
+    if (m_backing.size() != pixelSize) {
+        m_backing = QPixmap(pixelSize);
+        m_backing.setDevicePixelRatio(dpr);
+        m_damageAll = true;
+    }
+    if (m_backingFlags != paintState.invisibleFlags) {
+        // Text blink toggled
+        m_backingFlags = paintState.invisibleFlags;
+        m_damageAll = true;
+    }
+
+    QPainter painter(&m_backing);
+    CellState state(paintState);
+    painter.setFont(m_font);
+
+    if (m_damageAll) {
+        m_backing.fill(Qt::transparent);
+        for (const DisplayCell &cell: m_displayCells)
+            paintTerm(painter, cell, state);
+
+        m_damageAll = false;
+        m_lineDamage.assign(m_lineDamage.size(), false);
+        return;
+    }
+
+    qreal h = m_cellSize.height();
+    size_t nLines = m_lineStarts.empty() ? 0 : m_lineStarts.size() - 1;
+
+    for (size_t line = 0; line < m_lineDamage.size(); ++line) {
+        if (!m_lineDamage[line])
+            continue;
+
+        m_lineDamage[line] = false;
+        QRectF bounds(0.0, line * h, width(), h);
+
+        painter.setClipRect(bounds);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(bounds, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+        if (line < nLines)
+            for (size_t k = m_lineStarts[line]; k < m_lineStarts[line + 1]; ++k) {
+                paintTerm(painter, m_displayCells[k], state);
+                // Doublesize painting resets the clip
+                painter.setClipRect(bounds);
+            }
+
+        painter.setClipping(false);
+    }
+}
+
 void
 TermWidget::paintEvent(QPaintEvent *)
 {
@@ -627,11 +692,10 @@ TermWidget::paintEvent(QPaintEvent *)
         painter.resetTransform();
     }
 
-    // Draw emulator contents
+    // Draw emulator contents, rendering only damaged lines
+    paintBacking(state);
+    painter.drawPixmap(0, 0, m_backing);
     painter.setRenderHint(QPainter::Antialiasing, false);
-    for (const DisplayCell &cell: m_displayCells) {
-        paintTerm(painter, cell, state);
-    }
 
     // Draw fills
     if (m_nFills) {
@@ -9,6 +9,7 @@
 #include "settings/termlayout.h"
 
 #include <QWidget>
+#include <QPixmap>
 
 QT_BEGIN_NAMESPACE
 class QPropertyAnimation;
@@ -101,6 +102,11 @@ private:
 
     DragIcon *m_drag = nullptr;
 
+    // Rendered emulator contents, repainted line by line as damaged
+    QPixmap m_backing;
+    Tsq::CellFlags m_backingFlags = 0;
+    bool m_damageAll = true;
+
 private:
     void updateSize(const QSize &size);
     void updateIndexBounds(const QSize &size);
@@ -113,6 +119,7 @@ private:
     QPoint selectPosition() const;
 
     void paintBox(QPainter &painter, const DisplayCell &i, CellState &state);
+    void paintBacking(const CellState &state);
 
 protected:
     bool event(QEvent *event);
@@ -137,6 +144,7 @@ private slots:
     void refocus();
     void reindex(int index);
     void refont(const QFont &font);
+    void invalidate();
 
     void blink();
     void bell();
@@ -0,0 +1,142 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "urlscan.h"
+
+#include <cstring>
+#include <strings.h>
+
+namespace {
+    enum CharClass {
+        Word = 1, Body = 2, End = 4
+    };
+
+    struct CharTable {
+        unsigned char t[256];
+
+        CharTable() {
+            memset(t, 0, sizeof(t));
+
+            for (int c = '0'; c <= '9'; ++c)
+                t[c] = Word|Body|End;
+            for (int c = 'a'; c <= 'z'; ++c)
+                t[c] = t[c - 'a' + 'A'] = Word|Body|End;
+
+            t['_'] = Word|Body|End;
+            for (const char *p = "+&@#/%=~|$\\"; *p; ++p)
+                t[(unsigned char)*p] = Body|End;
+            for (const char *p = "-?!:,."; *p; ++p)
+                t[(unsigned char)*p] = Body;
+        }
+    };
+
+    struct Scheme {
+        const char *name;
+        size_t len;
+        bool slashes;
+    };
+}
+
+static const CharTable s_table;
+
+static const Scheme s_schemes[] = {
+    { "https", 5, true },
+    { "http", 4, true },
+    { "ftp", 3, true },
+    { "file", 4, true },
+    { "info", 4, false },
+    { "man", 3, false },
+};
+
+static inline bool
+is(char c, int cls)
+{
+    return s_table.t[(unsigned char)c] & cls;
+}
+
+// Returns the scheme start (not before lower) for a colon at pos, or npos
+static size_t
+matchScheme(const std::string &str, size_t lower, size_t pos, size_t &next)
+{
+    const char *base = str.data();
+
+    for (const auto &scheme: s_schemes) {
+        if (pos < lower + scheme.len)
+            continue;
+
+        size_t start = pos - scheme.len;
+        if (start && is(base[start - 1], Word))
+            continue;
+        if (strncasecmp(base + start, scheme.name, scheme.len))
+            continue;
+
+        next = pos + 1;
+        if (scheme.slashes) {
+            if (str.compare(next, 2, "//"))
+                continue;
+            next += 2;
+        }
+        return start;
+    }
+
+    return std::string::npos;
+}
+
+// Returns the end of the longest body starting at pos, or pos if none
+static size_t
+matchBody(const std::string &str, size_t pos)
+{
+    const char *base = str.data();
+    const size_t size = str.size();
+    size_t end = pos;
+
+    while (pos < size) {
+        char c = base[pos];
+
+        if (c == '(') {
+            // Parenthesized groups may not nest
+            size_t i = pos + 1;
+            while (i < size && is(base[i], Body))
+                ++i;
+            if (i == size || base[i] != ')')
+                break;
+            end = pos = i + 1;
+        }
+        else if (is(c, Body)) {
+            if (is(c, End))
+                end = pos + 1;
+            ++pos;
+        }
+        else {
+            break;
+        }
+    }
+
+    return end;
+}
+
+bool
+UrlScan::find(const std::string &str, size_t pos, size_t &start, size_t &end)
+{
+    const char *base = str.data();
+    const size_t size = str.size();
+    const size_t lower = pos;
+
+    while (pos < size) {
+        const char *colon = (const char *)memchr(base + pos, ':', size - pos);
+        if (!colon)
+            break;
+
+        size_t next, cpos = colon - base;
+        start = matchScheme(str, lower, cpos, next);
+
+        if (start != std::string::npos && (end = matchBody(str, next)) > next)
+            return true;
+
+        pos = cpos + 1;
+    }
+
+    return false;
+}
@@ -0,0 +1,17 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <string>
+
+//
+// Table-driven scanner for plain text links
+// Candidates are located by their scheme colon using memchr
+//
+namespace UrlScan
+{
+    // Byte span of the first link starting at or after pos
+    bool find(const std::string &str, size_t pos, size_t &start, size_t &end);
+}
@@ -4,6 +4,7 @@
 
 #include "common.h"
 #include "app/attr.h"
+#include "app/config.h"
 #include "app/exception.h"
 #include "app/logging.h"
 #include "listener.h"
@@ -262,6 +263,30 @@ TermListener::pushTermFetch(TermInstance *term, index_t start, index_t end, uint
     push(term, m.result());
 }
 
+void
+TermListener::pushTermSearch(TermInstance *term, uint8_t bufid, index_t start, bool up)
+{
+    const TermSearch &search = term->search();
+    unsigned flags = 0;
+
+    if (search.type == Tsqt::SingleLineEcmaRegex)
+        flags |= TSQ_SEARCH_REGEX;
+    if (!search.matchCase)
+        flags |= TSQ_SEARCH_ICASE;
+    if (up)
+        flags |= TSQ_SEARCH_REVERSE;
+
+    Tsq::ProtocolMarshaler m(TSQ_SEARCH_ROWS);
+    m.addUuidPair(term->id(), m_id);
+    m.addNumber(flags << 8 | bufid);
+    m.addNumber64(start);
+    m.addNumber64(SCAN_REMOTE_ROWS);
+    m.addNumber(1);
+    m.addString(search.text.toStdString());
+
+    push(term, m.result());
+}
+
 void
 TermListener::pushTermGetImage(TermInstance *term, contentid_t id)
 {
@@ -741,27 +766,41 @@ ServerConnection::wireTermBellRang(TermInstance *term, Tsq::ProtocolUnmarshaler
 void
 ServerConnection::wireTermRowChanged(TermInstance *term, Tsq::ProtocolUnmarshaler &unm, bool pushed)
 {
+    // Note: length checked and byte order fixed up by WireReader
     index_t row = unm.parseNumber64();
     const char *ptr = unm.remainingBytes();
     const uint32_t *data = reinterpret_cast<const uint32_t*>(ptr);
-    unsigned len = 12;
+    unsigned len = 12 + 24 * data[2];
 
-    if (unm.remainingLength() < len) {
-        throw TsqException("Unmarshal failed: invalid row output");
-    }
+    term->buffers()->setRow(row, data, ptr + len, unm.remainingLength() - len, pushed);
+}
 
-    len += 24 * le32toh(data[2]);
+void
+ServerConnection::wireTermRowPatched(TermInstance *term, Tsq::ProtocolUnmarshaler &unm)
+{
+    // Note: length checked and byte order fixed up by WireReader
+    index_t row = unm.parseNumber64();
+    const char *ptr = unm.remainingBytes();
+    const uint32_t *data = reinterpret_cast<const uint32_t*>(ptr);
+    unsigned len = 32 + 24 * data[3];
 
-    if (unm.remainingLength() < len) {
-        throw TsqException("Unmarshal failed: invalid row output");
+    if (!term->buffers()->patchRow(row, data, ptr + len, unm.remainingLength() - len)) {
+        // Our copy differs from the server's base, fetch the whole row
+        g_listener->pushTermFetch(term, row, row + 1, data[0] & 0xff);
     }
+}
 
-    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-    for (unsigned z = 0; z < len / 4; ++z)
-        const_cast<uint32_t*>(data)[z] = __builtin_bswap32(data[z]);
-    #endif
+void
+ServerConnection::wireTermSearchRows(TermInstance *term, Tsq::ProtocolUnmarshaler &unm)
+{
+    uint8_t bufid = unm.parseNumber();
+    index_t next = unm.parseNumber64();
+    index_t row = INVALID_INDEX;
 
-    term->buffers()->setRow(row, data, ptr + len, unm.remainingLength() - len, pushed);
+    if (unm.remainingLength())
+        row = unm.parseNumber64();
+
+    emit term->buffers()->fetchSearchRows(bufid, next, row);
 }
 
 void
@@ -901,6 +940,9 @@ ServerConnection::wireTermCommand(uint32_t command, Tsq::ProtocolUnmarshaler &un
     case TSQ_ROW_CONTENT_RESPONSE:
         wireTermRowChanged(term, unm, false);
         break;
+    case TSQ_ROW_DIFF:
+        wireTermRowPatched(term, unm);
+        break;
     case TSQ_REGION_UPDATE:
         wireTermRegionChanged(term, unm);
         break;
@@ -926,6 +968,9 @@ ServerConnection::wireTermCommand(uint32_t command, Tsq::ProtocolUnmarshaler &un
     case TSQ_IMAGE_CONTENT_RESPONSE:
         wireTermImageContent(term, unm);
         break;
+    case TSQ_SEARCH_ROWS_RESPONSE:
+        wireTermSearchRows(term, unm);
+        break;
     case TSQ_THROTTLE_RESUME:
         throttleResume(term, true);
         break;
@@ -984,6 +1029,7 @@ ServerConnection::wireClientCommand(uint32_t command, Tsq::ProtocolUnmarshaler &
     case TSQ_ROW_CONTENT_RESPONSE:
     case TSQ_END_OUTPUT_RESPONSE:
     case TSQ_IMAGE_CONTENT_RESPONSE:
+    case TSQ_SEARCH_ROWS_RESPONSE:
         wireTermCommand(command, unm);
         break;
     case TSQ_TASK_OUTPUT:
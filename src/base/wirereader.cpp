@@ -0,0 +1,156 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "app/exception.h"
+#include "wirereader.h"
+#include "lib/protocol.h"
+#include "lib/raw.h"
+#include "lib/term.h"
+#include "lib/zraw.h"
+
+#include <QSocketNotifier>
+#include <QThread>
+
+WireReader::WireReader(QThread *thread, int fd, int protocolType) :
+    m_thread(thread),
+    m_fd(fd)
+{
+    switch (protocolType) {
+    case TSQ_PROTOCOL_RAW_ZLIB:
+        m_machine = new Tsq::ZlibProtocol(this);
+        break;
+    case TSQ_PROTOCOL_RAW:
+        m_machine = new Tsq::RawProtocol(this);
+        break;
+    default:
+        m_machine = new Tsq::TermProtocol(this);
+        break;
+    }
+}
+
+WireReader::~WireReader()
+{
+    delete m_machine;
+}
+
+void
+WireReader::start()
+{
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &WireReader::handleRead);
+}
+
+void
+WireReader::quit()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    m_thread->quit();
+}
+
+void
+WireReader::post(WireStatus status)
+{
+    bool notify;
+
+    if (status != WireRunning)
+        m_notifier->setEnabled(false);
+    else if (m_local.empty())
+        return;
+
+    m_lock.lock();
+    notify = m_batch.empty() && m_status == WireRunning;
+    if (m_batch.empty())
+        m_batch.swap(m_local);
+    else
+        for (auto &msg: m_local)
+            m_batch.emplace_back(std::move(msg));
+    if (status != WireRunning)
+        m_status = status;
+    m_lock.unlock();
+
+    m_local.clear();
+    if (notify)
+        emit batchReady();
+}
+
+void
+WireReader::handleRead(int fd)
+{
+    try {
+        m_machine->connRead(fd);
+        post(WireRunning);
+    } catch (const std::exception &e) {
+        m_message = e.what();
+        post(WireFailed);
+    }
+}
+
+WireStatus
+WireReader::takeBatch(WireBatch &result, int &errnum, QString &message)
+{
+    QMutexLocker locker(&m_lock);
+    result.swap(m_batch);
+    errnum = m_errnum;
+    message = m_message;
+    return m_status;
+}
+
+void
+WireReader::eofCallback(int errnum)
+{
+    m_errnum = errnum;
+    post(WireEof);
+}
+
+void
+WireReader::writeFd(const char *, size_t)
+{
+    // Receive side only, the connection owns the sending machine
+}
+
+/*
+ * Row payloads are validated and byte-swapped here so that the GUI
+ * thread can hand them straight to the buffers
+ */
+void
+WireReader::prepareRow(uint32_t command, std::string &body)
+{
+    size_t offset = (command == TSQ_ROW_CONTENT_RESPONSE) ? 40 : 24;
+    size_t header = (command == TSQ_ROW_DIFF) ? 32 : 12;
+    size_t ranges = (command == TSQ_ROW_DIFF) ? 3 : 2;
+
+    if (body.size() < offset + header) {
+        throw TsqException("Unmarshal failed: invalid row output");
+    }
+
+    uint32_t *data = reinterpret_cast<uint32_t*>(&body[offset]);
+    size_t len = header + 24 * (size_t)le32toh(data[ranges]);
+
+    if (body.size() < offset + len) {
+        throw TsqException("Unmarshal failed: invalid row output");
+    }
+
+    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (unsigned z = 0; z < len / 4; ++z)
+        data[z] = __builtin_bswap32(data[z]);
+    #endif
+}
+
+bool
+WireReader::protocolCallback(uint32_t command, uint32_t length, const char *body)
+{
+    m_local.push_back(WireMessage{ command, std::string(body, length) });
+
+    switch (command) {
+    case TSQ_ROW_CONTENT:
+    case TSQ_ROW_CONTENT_RESPONSE:
+    case TSQ_ROW_DIFF:
+        prepareRow(command, m_local.back().body);
+        break;
+    }
+
+    return true;
+}
@@ -0,0 +1,74 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "lib/machine.h"
+
+#include <QObject>
+#include <QMutex>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+class QThread;
+QT_END_NAMESPACE
+
+struct WireMessage {
+    uint32_t command;
+    std::string body;
+};
+
+typedef std::vector<WireMessage> WireBatch;
+
+enum WireStatus {
+    WireRunning, WireEof, WireFailed
+};
+
+//
+// Thread worker: reads, frames, and decompresses the server protocol,
+// handing whole batches of messages to the connection on the GUI thread
+//
+class WireReader final: public QObject, public Tsq::ProtocolCallback
+{
+    Q_OBJECT
+
+private:
+    Tsq::ProtocolMachine *m_machine;
+    QSocketNotifier *m_notifier = nullptr;
+    QThread *m_thread;
+    int m_fd;
+
+    WireBatch m_local;
+
+    QMutex m_lock;
+    WireBatch m_batch;
+    WireStatus m_status = WireRunning;
+    int m_errnum = 0;
+    QString m_message;
+
+    void prepareRow(uint32_t command, std::string &body);
+    void post(WireStatus status);
+
+private slots:
+    void handleRead(int fd);
+
+signals:
+    void batchReady();
+
+public slots:
+    void start();
+    void quit();
+
+public:
+    WireReader(QThread *thread, int fd, int protocolType);
+    ~WireReader();
+
+    WireStatus takeBatch(WireBatch &result, int &errnum, QString &message);
+
+public:
+    bool protocolCallback(uint32_t command, uint32_t length, const char *body);
+    void writeFd(const char *buf, size_t len);
+    void eofCallback(int errnum);
+};
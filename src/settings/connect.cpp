@@ -86,6 +86,11 @@ static const SettingDef s_connectDefs[] = {
       TN("settings", "Use raw protocol encoding"),
       new CheckWidgetFactory
     },
+    { "Connection/UseCompression", "compress", QVariant::Bool,
+      TN("settings-category", "Connection"),
+      TN("settings", "Compress raw protocol traffic"),
+      new CheckWidgetFactory
+    },
     { "Connection/UseLocalPty", "pty", QVariant::Bool,
       TN("settings-category", "Connection"),
       TN("settings", "Run command in a local pty"),
@@ -126,6 +131,7 @@ ConnectSettings::initDefaults(bool anonymous)
     m_keepalive = 0;
     m_type = Tsqt::ConnectionGeneric;
     m_raw = false;
+    m_compress = false;
     m_pty = false;
 }
 
@@ -290,4 +296,5 @@ REG_SETTER(ConnectSettings::setEnviron, environ, const QStringList &)
 REG_SETTER(ConnectSettings::setDirectory, directory, const QString &)
 REG_SETTER(ConnectSettings::setKeepalive, keepalive, unsigned)
 REG_SETTER(ConnectSettings::setRaw, raw, bool)
+REG_SETTER(ConnectSettings::setCompress, compress, bool)
 REG_SETTER(ConnectSettings::setPty, pty, bool)
@@ -25,6 +25,7 @@ class ConnectSettings final: public SettingsBase
     Q_PROPERTY(unsigned keepalive READ keepalive WRITE setKeepalive)
     Q_PROPERTY(int type READ type WRITE setType)
     Q_PROPERTY(bool raw READ raw WRITE setRaw)
+    Q_PROPERTY(bool compress READ compress WRITE setCompress)
     Q_PROPERTY(bool pty READ pty WRITE setPty)
     // Hidden
     Q_PROPERTY(QStringList batch READ batch WRITE setBatch)
@@ -55,6 +56,7 @@ private:
     VALPROP(unsigned, keepalive, setKeepalive)
     VALPROP(int, type, setType)
     VALPROP(bool, raw, setRaw)
+    VALPROP(bool, compress, setCompress)
     VALPROP(bool, pty, setPty)
 
 private slots:
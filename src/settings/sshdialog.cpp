@@ -73,6 +73,7 @@ SshDialog::handleAccept()
         m_info->setCommand(command);
         m_info->setType(Tsqt::ConnectionSsh);
         m_info->setRaw(m_raw->isChecked());
+        m_info->setCompress(m_raw->isChecked());
         m_info->setPty(m_pty->isChecked());
         m_info->setKeepalive(KEEPALIVE_DEFAULT);
         doAccept();
@@ -89,6 +90,7 @@ SshDialog::makeConnection(const QString &dest)
     info->setCommand(command);
     info->setType(Tsqt::ConnectionSsh);
     info->setRaw(true);
+    info->setCompress(true);
     info->setPty(true);
     info->setKeepalive(KEEPALIVE_DEFAULT);
     return info;
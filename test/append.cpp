@@ -0,0 +1,84 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+
+static CellAttributes a, b;
+
+/*
+ * Bulk append tests
+ */
+static void plainRun(void**)
+{
+    DECLARE_ROW;
+
+    assert_int_equal(row.append(a, "abcd", 4), 4);
+
+    assert_int_equal(row.columns(), 4);
+    assert_int_equal(t.clusters(), 4);
+    assert_string_equal(row.str().c_str(), "abcd");
+    ASSERT_RANGE_SIZE(0);
+}
+
+static void flagsRun(void**)
+{
+    DECLARE_ROW;
+    LOAD_STR("ab", 2, 2);
+
+    assert_int_equal(row.append(b, "cde", 3), 5);
+
+    assert_int_equal(row.columns(), 5);
+    assert_int_equal(t.clusters(), 5);
+    assert_string_equal(row.str().c_str(), "abcde");
+    ASSERT_RANGES(2, 4, Tsq::Bold, 0, 0, INVALID_REGION_ID);
+}
+
+static void extendRange(void**)
+{
+    DECLARE_ROW;
+    LOAD_STR("ab", 2, 2);
+    LOAD_RANGES(1, 1, Tsq::Bold, 0, 0, INVALID_REGION_ID);
+
+    row.append(b, "cd", 2);
+
+    assert_int_equal(t.clusters(), 4);
+    ASSERT_RANGES(1, 3, Tsq::Bold, 0, 0, INVALID_REGION_ID);
+}
+
+static void matchesSingle(void**)
+{
+    DECLARE_ROW;
+    CellRow other;
+    TermEventTransfer u(other);
+    const char *str = "xyz";
+
+    row.append(a, "ab", 2);
+    row.append(b, str, 3);
+    other.append(a, "ab", 2);
+    for (const char *c = str; *c; ++c)
+        other.append(b, *c, 1);
+
+    assert_string_equal(row.str().c_str(), other.str().c_str());
+    assert_int_equal(row.columns(), other.columns());
+    assert_int_equal(t.clusters(), u.clusters());
+    assert_int_equal(t.ranges().size(), u.ranges().size());
+    assert_memory_equal(t.ranges().data(), u.ranges().data(), t.ranges().size() * 4);
+}
+
+int main()
+{
+    REGISTER_UNIPLUGIN(uniplugin_termy_init);
+
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(plainRun),
+        cmocka_unit_test(flagsRun),
+        cmocka_unit_test(extendRange),
+        cmocka_unit_test(matchesSingle),
+    };
+
+    b.flags = Tsq::Bold;
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
@@ -0,0 +1,209 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "mux/base/coldstore.cpp"
+
+#include <string>
+#include <climits>
+
+static CellAttributes a, b;
+
+static void
+fillBlock(std::vector<CellRow> &rows, index_t start)
+{
+    rows.clear();
+    rows.resize(SCROLLBACK_BLOCK_ROWS);
+
+    for (index_t i = 0; i < SCROLLBACK_BLOCK_ROWS; ++i) {
+        std::string str = "row" + std::to_string(start + i);
+        rows[i].append((i & 1) ? a : b, str.data(), str.size());
+        rows[i].flags = i & 1;
+    }
+}
+
+/*
+ * Compressed scrollback tests
+ */
+static void roundTrip(void**)
+{
+    ColdStore store;
+    std::vector<CellRow> rows;
+
+    store.reset(SCROLLBACK_BLOCK_ROWS);
+    fillBlock(rows, SCROLLBACK_BLOCK_ROWS);
+    store.push(rows);
+    fillBlock(rows, 2 * SCROLLBACK_BLOCK_ROWS);
+    store.push(rows);
+
+    assert_int_equal(store.start(), SCROLLBACK_BLOCK_ROWS);
+    assert_int_equal(store.end(), 3 * SCROLLBACK_BLOCK_ROWS);
+    assert_false(store.contains(0));
+
+    for (index_t i = store.start(); i < store.end(); ++i) {
+        CellRow row = store.row(i);
+        TermEventTransfer t(row);
+        std::string str = "row" + std::to_string(i);
+
+        assert_string_equal(row.str().c_str(), str.c_str());
+        assert_int_equal(row.flags, i & 1);
+        ASSERT_RANGE_SIZE((i & 1) ? 0 : 6);
+    }
+}
+
+static void popDrop(void**)
+{
+    ColdStore store;
+    std::vector<CellRow> rows;
+
+    for (index_t i = 0; i < 3; ++i) {
+        fillBlock(rows, i * SCROLLBACK_BLOCK_ROWS);
+        store.push(rows);
+    }
+
+    // Populate the cache with the last block before removing it
+    store.row(2 * SCROLLBACK_BLOCK_ROWS);
+    store.pop(rows);
+
+    assert_int_equal(store.end(), 2 * SCROLLBACK_BLOCK_ROWS);
+    assert_string_equal(rows[1].str().c_str(),
+                        ("row" + std::to_string(2 * SCROLLBACK_BLOCK_ROWS + 1)).c_str());
+
+    store.dropBelow(SCROLLBACK_BLOCK_ROWS + 1);
+
+    assert_int_equal(store.start(), SCROLLBACK_BLOCK_ROWS);
+    assert_string_equal(store.row(SCROLLBACK_BLOCK_ROWS).str().c_str(),
+                        ("row" + std::to_string(SCROLLBACK_BLOCK_ROWS)).c_str());
+}
+
+static void spillFile(void**)
+{
+    ColdStore store;
+    std::vector<CellRow> rows;
+
+    store.setWindow(1);
+    for (index_t i = 0; i < 4; ++i) {
+        fillBlock(rows, i * SCROLLBACK_BLOCK_ROWS);
+        store.push(rows);
+    }
+
+    assert_int_equal(store.spilled(), 3);
+
+    for (index_t i = store.start(); i < store.end(); i += 7) {
+        std::string str = "row" + std::to_string(i);
+        assert_string_equal(store.row(i).str().c_str(), str.c_str());
+    }
+
+    store.dropBelow(SCROLLBACK_BLOCK_ROWS);
+    assert_int_equal(store.spilled(), 2);
+
+    store.pop(rows);
+    store.pop(rows);
+    assert_int_equal(store.spilled(), 1);
+    assert_string_equal(rows[0].str().c_str(),
+                        ("row" + std::to_string(2 * SCROLLBACK_BLOCK_ROWS)).c_str());
+}
+
+static void rebase(void**)
+{
+    ColdStore store;
+    std::vector<CellRow> rows;
+    const index_t delta = 5;
+
+    store.reset(SCROLLBACK_BLOCK_ROWS);
+    for (index_t i = 1; i < 4; ++i) {
+        fillBlock(rows, i * SCROLLBACK_BLOCK_ROWS);
+        store.push(rows);
+    }
+
+    // Renumbering leaves blocks unaligned, lookups follow the start
+    store.row(2 * SCROLLBACK_BLOCK_ROWS);
+    store.rebase(delta);
+    assert_int_equal(store.start(), SCROLLBACK_BLOCK_ROWS - delta);
+    assert_false(store.contains(SCROLLBACK_BLOCK_ROWS - delta - 1));
+
+    for (index_t i = store.start(); i < store.end(); i += 5) {
+        std::string str = "row" + std::to_string(i + delta);
+        assert_string_equal(store.row(i).str().c_str(), str.c_str());
+    }
+
+    assert_true(store.shift(rows));
+    assert_int_equal(store.start(), 2 * SCROLLBACK_BLOCK_ROWS - delta);
+    assert_string_equal(rows[0].str().c_str(),
+                        ("row" + std::to_string(SCROLLBACK_BLOCK_ROWS)).c_str());
+
+    store.dropBelow(3 * SCROLLBACK_BLOCK_ROWS - delta);
+    store.rebase(SCROLLBACK_BLOCK_ROWS);
+    assert_int_equal(store.start(), 2 * SCROLLBACK_BLOCK_ROWS - delta);
+    assert_string_equal(store.row(store.start()).str().c_str(),
+                        ("row" + std::to_string(3 * SCROLLBACK_BLOCK_ROWS)).c_str());
+
+    // An empty store starts over at zero
+    store.pop(rows);
+    store.rebase(delta);
+    assert_true(store.empty());
+    assert_int_equal(store.start(), 0);
+}
+
+static void straddle(void**)
+{
+    ColdStore store;
+    std::vector<CellRow> rows;
+    const index_t delta = SCROLLBACK_BLOCK_ROWS + 5;
+
+    store.reset(SCROLLBACK_BLOCK_ROWS);
+    for (index_t i = 1; i < 4; ++i) {
+        fillBlock(rows, i * SCROLLBACK_BLOCK_ROWS);
+        store.push(rows);
+    }
+
+    // Renumbering past the start hides the leading rows of the first block
+    store.rebase(delta);
+    assert_int_equal(store.start(), 0);
+    assert_int_equal(store.end(), 4 * SCROLLBACK_BLOCK_ROWS - delta);
+
+    for (index_t i = store.start(); i < store.end(); i += 3) {
+        std::string str = "row" + std::to_string(i + delta);
+        assert_string_equal(store.row(i).str().c_str(), str.c_str());
+    }
+
+    assert_true(store.shift(rows));
+    assert_int_equal(rows.size(), 2 * SCROLLBACK_BLOCK_ROWS - delta);
+    assert_string_equal(rows[0].str().c_str(),
+                        ("row" + std::to_string(delta)).c_str());
+    assert_int_equal(store.start(), 2 * SCROLLBACK_BLOCK_ROWS - delta);
+
+    // Popping the last block returns only its visible rows
+    store.dropBelow(3 * SCROLLBACK_BLOCK_ROWS - delta);
+    store.rebase(2);
+    store.pop(rows);
+    assert_true(store.empty());
+    assert_int_equal(rows.size(), SCROLLBACK_BLOCK_ROWS);
+    assert_string_equal(rows[0].str().c_str(),
+                        ("row" + std::to_string(3 * SCROLLBACK_BLOCK_ROWS)).c_str());
+}
+
+int main()
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "/tmp/coldstore-test.%d", getpid());
+    osCreateRuntimeDir(path, path);
+
+    REGISTER_UNIPLUGIN(uniplugin_termy_init);
+
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(roundTrip),
+        cmocka_unit_test(popDrop),
+        cmocka_unit_test(spillFile),
+        cmocka_unit_test(rebase),
+        cmocka_unit_test(straddle),
+    };
+
+    b.flags = Tsq::Bold;
+
+    int rc = cmocka_run_group_tests(tests, nullptr, nullptr);
+    rmdir(path);
+    return rc;
+}
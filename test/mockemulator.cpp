@@ -5,6 +5,7 @@
 #include "common.h"
 #include "mockemulator.h"
 
+#include "mux/base/attrtable.cpp"
 #include "mux/base/cell.cpp"
 #include "mux/base/codestring.cpp"
 
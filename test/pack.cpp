@@ -0,0 +1,138 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "mux/base/attrtable.h"
+
+static CellAttributes a, b, c;
+
+/*
+ * Packed row tests
+ */
+static void noRanges(void**)
+{
+    DECLARE_ROW;
+    AttributeTable table;
+
+    row.append(a, "abcd", 4);
+    row.pack(table);
+
+    assert_false(row.isPacked());
+    assert_false(row.isEmpty());
+    assert_int_equal(table.size(), 0);
+    assert_string_equal(row.str().c_str(), "abcd");
+}
+
+static void roundTrip(void**)
+{
+    DECLARE_ROW;
+    AttributeTable table;
+
+    row.append(b, "ab", 2);
+    row.append(a, "cd", 2);
+    row.append(c, "ef", 2);
+    row.append(b, "gh", 2);
+    row.pack(table);
+
+    assert_true(row.isPacked());
+    assert_int_equal(table.size(), 2);
+    assert_int_equal(t.ranges().size(), 6);
+    assert_string_equal(row.str().c_str(), "abcdefgh");
+
+    row.unpack(table);
+
+    assert_false(row.isPacked());
+    assert_int_equal(t.clusters(), 8);
+    ASSERT_RANGES(0, 1, Tsq::Bold, 0, 0, INVALID_REGION_ID,
+                  4, 5, Tsq::Underline, 3, 4, INVALID_REGION_ID,
+                  6, 7, Tsq::Bold, 0, 0, INVALID_REGION_ID);
+}
+
+static void sharedTable(void**)
+{
+    DECLARE_ROW;
+    CellRow other;
+    TermEventTransfer u(other);
+    AttributeTable table;
+
+    row.append(c, "ab", 2);
+    other.append(a, "x", 1);
+    other.append(c, "y", 1);
+    row.pack(table);
+    other.pack(table);
+
+    assert_int_equal(table.size(), 1);
+
+    other.unpack(table);
+    assert_int_equal(u.ranges().size(), 6);
+    assert_int_equal(u.ranges()[0], 1);
+    assert_int_equal(u.ranges()[1], 1);
+    assert_int_equal(u.ranges()[2], Tsq::Underline);
+}
+
+static void sweep(void**)
+{
+    DECLARE_ROW;
+    CellRow other;
+    AttributeTable table;
+
+    row.append(b, "ab", 2);
+    other.append(c, "cd", 2);
+    row.pack(table);
+    other.pack(table);
+    assert_int_equal(table.used(), 2);
+
+    // Only entries held by packed rows survive
+    std::vector<bool> live(table.size());
+    row.markAttributes(live);
+    assert_int_equal(table.sweep(live), 1);
+    assert_int_equal(table.sweep(live), 0);
+    assert_int_equal(table.used(), 1);
+
+    // Freed ids are reused before the table grows
+    CellAttributes d = c;
+    d.fg = 7;
+    assert_int_equal(table.intern(d), 1);
+    assert_int_equal(table.intern(b), 0);
+    assert_int_equal(table.size(), 2);
+
+    row.unpack(table);
+    ASSERT_RANGES(0, 1, Tsq::Bold, 0, 0, INVALID_REGION_ID);
+}
+
+static void fullTable(void**)
+{
+    DECLARE_ROW;
+    AttributeTable table;
+    CellAttributes d;
+
+    for (d.fg = 0; d.fg < ATTRTABLE_MAX; ++d.fg)
+        table.intern(d);
+
+    row.append(c, "ab", 2);
+    assert_false(row.pack(table));
+    assert_false(row.isPacked());
+    assert_string_equal(row.str().c_str(), "ab");
+}
+
+int main()
+{
+    REGISTER_UNIPLUGIN(uniplugin_termy_init);
+
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(noRanges),
+        cmocka_unit_test(roundTrip),
+        cmocka_unit_test(sharedTable),
+        cmocka_unit_test(sweep),
+        cmocka_unit_test(fullTable),
+    };
+
+    b.flags = Tsq::Bold;
+    c.flags = Tsq::Underline;
+    c.fg = 3;
+    c.bg = 4;
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
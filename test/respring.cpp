@@ -0,0 +1,86 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "mux/base/respring.cpp"
+
+#include <thread>
+#include <vector>
+
+/*
+ * Response ring tests
+ */
+static void fillDrain(void**)
+{
+    ResponseRing ring(4);
+    std::string buf;
+
+    assert_null(ring.front());
+
+    for (int i = 0; i < 4; ++i) {
+        buf = std::to_string(i);
+        assert_true(ring.push(buf));
+    }
+    buf = "x";
+    assert_false(ring.push(buf));
+
+    for (int i = 0; i < 4; ++i) {
+        assert_non_null(ring.front());
+        assert_string_equal(ring.front()->c_str(), std::to_string(i).c_str());
+        ring.pop();
+    }
+    assert_null(ring.front());
+
+    // Wraps around
+    assert_true(ring.push(buf));
+    assert_string_equal(ring.front()->c_str(), "x");
+}
+
+static void producers(void**)
+{
+    ResponseRing ring(64);
+    const int nthreads = 4, count = 10000;
+    std::vector<std::thread> threads;
+    std::vector<int> last(nthreads, -1);
+    int total = 0;
+
+    for (int t = 0; t < nthreads; ++t)
+        threads.emplace_back([&ring, t]() {
+            for (int i = 0; i < count; ++i) {
+                std::string buf = std::to_string(t) + ':' + std::to_string(i);
+                while (!ring.push(buf))
+                    std::this_thread::yield();
+            }
+        });
+
+    // Each producer's responses arrive in order
+    while (total < nthreads * count) {
+        std::string *buf = ring.front();
+        if (!buf) {
+            std::this_thread::yield();
+            continue;
+        }
+        int t = std::stoi(*buf);
+        int i = std::stoi(buf->substr(buf->find(':') + 1));
+        assert_int_equal(i, last[t] + 1);
+        last[t] = i;
+        ring.pop();
+        ++total;
+    }
+
+    for (auto &thread: threads)
+        thread.join();
+    assert_null(ring.front());
+}
+
+int main()
+{
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(fillDrain),
+        cmocka_unit_test(producers),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
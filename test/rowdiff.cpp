@@ -0,0 +1,156 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "lib/rowdiff.h"
+
+#include <zlib.h>
+#include <cstdlib>
+
+/*
+ * Row diff tests
+ */
+typedef std::vector<uint32_t> Ranges;
+
+// Applies a diff of row against prev to base and checks the result
+static bool
+roundTrip(const Ranges &pr, const std::string &ps, const Ranges &r, const std::string &s,
+          const Ranges &base, const std::string &bstr)
+{
+    Tsq::RowDiff diff;
+    Tsq::diffRows(pr, ps, r, s, diff);
+
+    Ranges outRanges;
+    std::string outStr;
+
+    if (!Tsq::patchRow(base, bstr, Tsq::rowChecksum(pr, ps), diff,
+                       r.data() + diff.rstart * 6, s.data() + diff.sstart,
+                       outRanges, outStr))
+        return false;
+
+    assert_true(outRanges == r);
+    assert_true(outStr == s);
+    return true;
+}
+
+static void spans(void**)
+{
+    Ranges pr = { 0, 4, 1, 2, 3, 0,  5, 9, 1, 2, 3, 0,  10, 12, 4, 0, 0, 0 };
+    Ranges r = { 0, 4, 1, 2, 3, 0,  5, 7, 1, 2, 3, 0,  8, 9, 7, 2, 3, 0,  10, 12, 4, 0, 0, 0 };
+    std::string ps = "hello world, bye", s = "hello there world, bye";
+    Tsq::RowDiff diff;
+
+    // Only the middle range and the inserted text are sent
+    Tsq::diffRows(pr, ps, r, s, diff);
+    assert_int_equal(diff.rstart, 1);
+    assert_int_equal(diff.rremove, 1);
+    assert_int_equal(diff.radd, 2);
+    assert_int_equal(diff.sstart, 6);
+    assert_int_equal(diff.sremove, 0);
+    assert_int_equal(diff.sadd, 6);
+    assert_memory_equal(s.data() + diff.sstart, "there ", 6);
+
+    // Unchanged rows produce an empty diff
+    Tsq::diffRows(r, s, r, s, diff);
+    assert_int_equal(diff.rremove + diff.radd, 0);
+    assert_int_equal(diff.sremove + diff.sadd, 0);
+    assert_int_equal(diff.rstart, 4);
+    assert_int_equal(diff.sstart, s.size());
+
+    // Prefix and suffix may not overlap on repeated text
+    Tsq::diffRows(Ranges(), "aaa", Ranges(), "aaaa", diff);
+    assert_int_equal(diff.sstart, 3);
+    assert_int_equal(diff.sremove, 0);
+    assert_int_equal(diff.sadd, 1);
+
+    Tsq::diffRows(Ranges(), "abcabc", Ranges(), "abc", diff);
+    assert_int_equal(diff.sstart, 3);
+    assert_int_equal(diff.sremove, 3);
+    assert_int_equal(diff.sadd, 0);
+
+    assert_true(roundTrip(pr, ps, r, s, pr, ps));
+    assert_true(roundTrip(r, s, pr, ps, r, s));
+    assert_true(roundTrip(pr, ps, Ranges(), std::string(), pr, ps));
+    assert_true(roundTrip(Ranges(), std::string(), r, s, Ranges(), std::string()));
+}
+
+static void checksum(void**)
+{
+    Ranges r = { 1, 2, 0x01020304, 0, 0, 0 };
+    std::string s = "xyz";
+
+    // Range words are summed in little endian order, then the text
+    const unsigned char bytes[] = {
+        1, 0, 0, 0,  2, 0, 0, 0,  4, 3, 2, 1,  0, 0, 0, 0,  0, 0, 0, 0,  0, 0, 0, 0,
+        'x', 'y', 'z'
+    };
+    uLong crc = crc32(crc32(0, Z_NULL, 0), bytes, sizeof(bytes));
+    assert_int_equal(Tsq::rowChecksum(r, s), crc);
+
+    // Any change to the ranges or text changes the sum
+    Ranges r2 = r;
+    r2[4] = 1;
+    assert_true(Tsq::rowChecksum(r2, s) != crc);
+    assert_true(Tsq::rowChecksum(r, "xyZ") != crc);
+    assert_true(Tsq::rowChecksum(Ranges(), "xyz") != crc);
+}
+
+static void mismatch(void**)
+{
+    Ranges pr = { 0, 3, 1, 0, 0, 0 }, r = { 0, 3, 2, 0, 0, 0 };
+    std::string ps = "abcd", s = "abXd";
+    Tsq::RowDiff diff;
+    Tsq::diffRows(pr, ps, r, s, diff);
+
+    // A base that differs from the one diffed against is refused, so the
+    // client falls back to fetching the whole row
+    assert_false(roundTrip(pr, ps, r, s, pr, "abcD"));
+    assert_false(roundTrip(pr, ps, r, s, r, ps));
+
+    // As is a diff reaching past the end of the base
+    Ranges outRanges;
+    std::string outStr;
+    uint32_t sum = Tsq::rowChecksum(Ranges(), "ab");
+    assert_false(Tsq::patchRow(Ranges(), "ab", sum, diff, r.data(), s.data() + 2,
+                               outRanges, outStr));
+    assert_true(outRanges.empty());
+    assert_true(outStr.empty());
+
+    assert_true(roundTrip(pr, ps, r, s, pr, ps));
+}
+
+static void randomRows(void**)
+{
+    srand(1);
+
+    auto randomRow = [](Ranges &r, std::string &s) {
+        r.clear();
+        s.clear();
+        for (int i = rand() % 4; i; --i)
+            r.insert(r.end(), { (uint32_t)i, (uint32_t)i + 1, (uint32_t)rand() % 3, 0, 0, 0 });
+        for (int i = rand() % 12; i; --i)
+            s.push_back('a' + rand() % 3);
+    };
+
+    for (int i = 0; i < 2000; ++i) {
+        Ranges pr, r;
+        std::string ps, s;
+        randomRow(pr, ps);
+        randomRow(r, s);
+        assert_true(roundTrip(pr, ps, r, s, pr, ps));
+    }
+}
+
+int main()
+{
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(spans),
+        cmocka_unit_test(checksum),
+        cmocka_unit_test(mismatch),
+        cmocka_unit_test(randomRows),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
@@ -0,0 +1,198 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "mux/base/rowsearch.cpp"
+
+/*
+ * Scrollback search matcher tests
+ */
+static unsigned
+findAll(const RowSearch &search, const char *str, index_t row, TermUnicoding *wl,
+        std::vector<RowMatch> &results)
+{
+    SearchLine line;
+    line.row = row;
+    line.str = str;
+
+    unsigned rc = search.findAll(line, 0, INVALID_INDEX, SEARCH_MAX_RESULTS, false);
+    RowSearch::convert(line, wl, results);
+    return rc;
+}
+
+static void literal(void**)
+{
+    auto *wl = new TermUnicoding();
+    std::vector<RowMatch> results;
+    RowSearch search("ab", 0);
+
+    assert_int_equal(findAll(search, "xxabyyab", 7, wl, results), 2);
+    assert_int_equal(results[0].row, 7);
+    assert_int_equal(results[0].start, 2);
+    assert_int_equal(results[0].end, 4);
+    assert_int_equal(results[1].start, 6);
+    assert_int_equal(results[1].end, 8);
+
+    results.clear();
+    assert_int_equal(findAll(search, "xxAByy", 0, wl, results), 0);
+    assert_int_equal(findAll(search, "a", 0, wl, results), 0);
+    delete wl;
+}
+
+static void ignoreCase(void**)
+{
+    auto *wl = new TermUnicoding();
+    std::vector<RowMatch> results;
+    RowSearch search("aB.", TSQ_SEARCH_ICASE);
+
+    assert_int_equal(findAll(search, "Ab.ab.AB!", 0, wl, results), 2);
+    assert_int_equal(results[0].start, 0);
+    assert_int_equal(results[1].start, 3);
+    delete wl;
+}
+
+static void regex(void**)
+{
+    auto *wl = new TermUnicoding();
+    std::vector<RowMatch> results;
+    RowSearch search("[0-9]+", TSQ_SEARCH_REGEX);
+
+    assert_int_equal(findAll(search, "a12b345", 0, wl, results), 2);
+    assert_int_equal(results[0].start, 1);
+    assert_int_equal(results[0].end, 3);
+    assert_int_equal(results[1].start, 4);
+    assert_int_equal(results[1].end, 7);
+    delete wl;
+}
+
+static void clusters(void**)
+{
+    auto *wl = new TermUnicoding();
+    std::vector<RowMatch> results;
+    RowSearch search("b", 0);
+
+    // Positions count clusters, not bytes
+    assert_int_equal(findAll(search, "a" CMB DW "b", 0, wl, results), 1);
+    assert_int_equal(results[0].start, 2);
+    assert_int_equal(results[0].end, 3);
+    delete wl;
+}
+
+static void continuation(void**)
+{
+    auto *wl = new TermUnicoding();
+    std::vector<RowMatch> results;
+    RowSearch search("cd", 0);
+    SearchLine line;
+
+    // Rows "xab", "cdx" and "ycd" joined into one logical line
+    line.row = 10;
+    line.str = "xabcdxycd";
+    line.breaks = { 3, 6 };
+
+    assert_int_equal(search.findAll(line, 0, INVALID_INDEX, SEARCH_MAX_RESULTS, false), 2);
+    RowSearch::convert(line, wl, results);
+    assert_int_equal(results[0].row, 11);
+    assert_int_equal(results[0].start, 0);
+    assert_int_equal(results[0].end, 2);
+    assert_int_equal(results[1].row, 12);
+    assert_int_equal(results[1].start, 1);
+
+    // Matches wrapping onto the next row belong to the first
+    RowSearch wrap("bcd", 0);
+    line.spans.clear();
+    results.clear();
+    assert_int_equal(wrap.findAll(line, 0, INVALID_INDEX, SEARCH_MAX_RESULTS, false), 1);
+    RowSearch::convert(line, wl, results);
+    assert_int_equal(results[0].row, 10);
+    assert_int_equal(results[0].start, 2);
+    assert_int_equal(results[0].end, 5);
+
+    // Rows outside the bounds are skipped
+    line.spans.clear();
+    assert_int_equal(search.findAll(line, 12, INVALID_INDEX, SEARCH_MAX_RESULTS, false), 1);
+    line.spans.clear();
+    assert_int_equal(search.findAll(line, 0, 11, SEARCH_MAX_RESULTS, false), 1);
+    delete wl;
+}
+
+static void limit(void**)
+{
+    RowSearch search("a", 0);
+    SearchLine line;
+
+    // Rows "aa", "aa" and "aa" joined into one logical line
+    line.row = 20;
+    line.str = "aaaaaa";
+    line.breaks = { 2, 4 };
+
+    // The row cut partway through is left for the next request
+    assert_int_equal(search.findAll(line, 0, INVALID_INDEX, 3, false), 2);
+    assert_int_equal(line.spans.back().first, 1);
+    assert_int_equal(line.resume, 21);
+
+    line.spans.clear();
+    line.resume = INVALID_INDEX;
+    assert_int_equal(search.findAll(line, 0, INVALID_INDEX, 3, true), 2);
+    assert_int_equal(line.spans.front().first, 4);
+    assert_int_equal(line.resume, 21);
+
+    // Unless that row alone has too many matches
+    line.spans.clear();
+    line.resume = INVALID_INDEX;
+    assert_int_equal(search.findAll(line, 0, INVALID_INDEX, 1, false), 1);
+    assert_int_equal(line.resume, 21);
+
+    line.spans.clear();
+    line.resume = INVALID_INDEX;
+    assert_int_equal(search.findAll(line, 0, INVALID_INDEX, 1, true), 1);
+    assert_int_equal(line.spans.front().first, 5);
+    assert_int_equal(line.resume, 21);
+
+    // Exactly the limit is not a cut
+    line.spans.clear();
+    line.resume = INVALID_INDEX;
+    assert_int_equal(search.findAll(line, 0, INVALID_INDEX, 6, false), 6);
+    assert_int_equal(line.resume, INVALID_INDEX);
+}
+
+static void badPattern(void**)
+{
+    bool thrown = false;
+
+    try {
+        RowSearch search("(", TSQ_SEARCH_REGEX);
+    } catch (const std::regex_error &) {
+        thrown = true;
+    }
+
+    assert_true(thrown);
+
+    thrown = false;
+    try {
+        RowSearch search(std::string(SEARCH_MAX_PATTERN + 1, 'a'), 0);
+    } catch (const std::regex_error &) {
+        thrown = true;
+    }
+
+    assert_true(thrown);
+}
+
+int main()
+{
+    REGISTER_UNIPLUGIN(uniplugin_termy_init);
+
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(literal),
+        cmocka_unit_test(ignoreCase),
+        cmocka_unit_test(regex),
+        cmocka_unit_test(clusters),
+        cmocka_unit_test(continuation),
+        cmocka_unit_test(limit),
+        cmocka_unit_test(badPattern),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
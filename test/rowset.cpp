@@ -0,0 +1,118 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "mux/base/rowset.cpp"
+
+#include <set>
+
+#define ITERATIONS 100000
+
+static void assertSame(const RowSet &rows, const std::set<index_t> &ref)
+{
+    assert_int_equal(rows.size(), ref.size());
+
+    auto j = ref.begin();
+    for (index_t i: rows) {
+        assert_int_equal(i, *j);
+        ++j;
+    }
+}
+
+static void sequential(void**)
+{
+    RowSet rows;
+
+    for (index_t i = 10; i < 20; ++i)
+        rows.insert(i);
+    rows.insert(15);
+    rows.insert(21);
+
+    std::set<index_t> ref = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 21 };
+    assertSame(rows, ref);
+
+    rows.popFront();
+    ref.erase(ref.begin());
+    assertSame(rows, ref);
+
+    rows.insert(20);
+    ref.insert(20);
+    assertSame(rows, ref);
+}
+
+static void ranges(void**)
+{
+    RowSet rows;
+
+    rows.insert(5, 8);
+    rows.insert(12, 15);
+    rows.insert(0, 2);
+    rows.insert(7, 13);
+
+    std::set<index_t> ref = { 0, 1, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+    assertSame(rows, ref);
+
+    rows.eraseBelow(6);
+    ref.erase(ref.begin(), ref.find(6));
+    assertSame(rows, ref);
+
+    rows.truncate(4);
+    while (ref.size() > 4)
+        ref.erase(ref.begin());
+    assertSame(rows, ref);
+}
+
+static void randomized(void**)
+{
+    RowSet rows, other;
+    std::set<index_t> ref;
+
+    srandom(1);
+
+    for (int n = 0; n < ITERATIONS; ++n) {
+        index_t i = random() % 200;
+        index_t j = i + random() % 10;
+
+        switch (random() % 8) {
+        case 0:
+            rows.insert(i, j);
+            for (; i < j; ++i)
+                ref.insert(i);
+            break;
+        case 1:
+            rows.eraseBelow(i);
+            ref.erase(ref.begin(), ref.lower_bound(i));
+            break;
+        case 2:
+            rows.truncate(j);
+            while (ref.size() > j)
+                ref.erase(ref.begin());
+            break;
+        case 3:
+            other.insert(i);
+            rows.insert(other);
+            for (index_t k: other)
+                ref.insert(k);
+            break;
+        default:
+            rows.insert(i);
+            ref.insert(i);
+            break;
+        }
+
+        assertSame(rows, ref);
+    }
+}
+
+int main()
+{
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(sequential),
+        cmocka_unit_test(ranges),
+        cmocka_unit_test(randomized),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
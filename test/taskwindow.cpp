@@ -0,0 +1,124 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "mux/base/taskwindow.cpp"
+
+#define CHUNK 1000
+
+/*
+ * Adaptive task window tests
+ */
+static void
+roundTrip(TaskWindow &w, size_t &sent, int64_t &now, int64_t rtt)
+{
+    size_t acked = sent;
+    sent += w.window();
+    w.sent(sent, acked, now);
+    now += rtt;
+    w.acked(sent, now);
+}
+
+static void initial(void**)
+{
+    TaskWindow w(CHUNK, 8);
+
+    assert_int_equal(w.window(), 8 * CHUNK);
+    assert_true(w.open(7 * CHUNK, 0));
+    assert_false(w.open(8 * CHUNK, 0));
+
+    // Never below two chunks
+    TaskWindow w2(CHUNK, 1);
+    assert_int_equal(w2.window(), 2 * CHUNK);
+}
+
+static void grow(void**)
+{
+    TaskWindow w(CHUNK, 8);
+    size_t sent = 0;
+    int64_t now = 1000;
+
+    // Steady round trips double the window, then cap it
+    roundTrip(w, sent, now, 50);
+    assert_int_equal(w.window(), 16 * CHUNK);
+    roundTrip(w, sent, now, 50);
+    assert_int_equal(w.window(), 32 * CHUNK);
+
+    for (int i = 0; i < 40; ++i)
+        roundTrip(w, sent, now, 50);
+    assert_int_equal(w.window(), TASK_WINDOW_MAX / CHUNK * CHUNK);
+    assert_int_equal(w.rtt(), 50);
+    assert_true(w.rate() > 0);
+}
+
+static void shrink(void**)
+{
+    TaskWindow w(CHUNK, 64);
+    size_t sent = 0;
+    int64_t now = 1000;
+
+    roundTrip(w, sent, now, 20);
+    size_t peak = w.window();
+
+    // Inflating round trips mean data is queueing, back off
+    for (int i = 0; i < 10; ++i)
+        roundTrip(w, sent, now, 200);
+    assert_true(w.window() < peak);
+
+    for (int i = 0; i < 1000; ++i)
+        roundTrip(w, sent, now, 200);
+    assert_true(w.window() >= 2 * CHUNK);
+}
+
+static void partialAck(void**)
+{
+    TaskWindow w(CHUNK, 8);
+    int64_t now = 1000;
+
+    // The probe waits for the chunk boundary after the bytes sent
+    w.sent(8 * CHUNK + 500, 0, now);
+    w.acked(2 * CHUNK, now + 10);
+    w.acked(8 * CHUNK + 600, now + 20);
+    assert_int_equal(w.rtt(), 0);
+    assert_int_equal(w.window(), 8 * CHUNK);
+
+    w.acked(9 * CHUNK, now + 30);
+    assert_int_equal(w.rtt(), 30);
+}
+
+static void appLimited(void**)
+{
+    TaskWindow w(CHUNK, 8);
+    size_t sent = 0;
+    int64_t now = 1000;
+
+    // A sender that never fills the window neither samples nor grows
+    for (int i = 0; i < 10; ++i) {
+        sent += CHUNK;
+        w.sent(sent, sent - CHUNK, now);
+        now += 5000;
+        w.acked(sent, now);
+    }
+    assert_int_equal(w.rtt(), 0);
+    assert_int_equal(w.window(), 8 * CHUNK);
+
+    // Filling the window resumes sampling
+    roundTrip(w, sent, now, 50);
+    assert_int_equal(w.rtt(), 50);
+    assert_int_equal(w.window(), 16 * CHUNK);
+}
+
+int main()
+{
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(initial),
+        cmocka_unit_test(grow),
+        cmocka_unit_test(shrink),
+        cmocka_unit_test(partialAck),
+        cmocka_unit_test(appLimited),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
@@ -0,0 +1,88 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "src/base/urlscan.cpp"
+
+/*
+ * Plain text link scanner tests
+ */
+static std::string
+first(const std::string &str, size_t pos = 0)
+{
+    size_t start, end;
+
+    if (!UrlScan::find(str, pos, start, end))
+        return std::string();
+
+    assert_true(start >= pos);
+    assert_true(start < end && end <= str.size());
+    return str.substr(start, end - start);
+}
+
+static void schemes(void**)
+{
+    assert_string_equal(first("see https://example.com/a?b=c for").c_str(),
+                        "https://example.com/a?b=c");
+    assert_string_equal(first("HTTP://Example.com").c_str(), "HTTP://Example.com");
+    assert_string_equal(first("ftp://host/file").c_str(), "ftp://host/file");
+    assert_string_equal(first("file:///etc/passwd").c_str(), "file:///etc/passwd");
+    assert_string_equal(first("run man:ls(1)").c_str(), "man:ls(1)");
+    assert_string_equal(first("info:coreutils").c_str(), "info:coreutils");
+
+    // Not links
+    assert_true(first("no links here").empty());
+    assert_true(first("http:/example.com").empty());
+    assert_true(first("xhttp://example.com").empty());
+    assert_true(first("http://").empty());
+    assert_true(first("time 12:34:56").empty());
+}
+
+static void body(void**)
+{
+    // Trailing punctuation is not part of the link
+    assert_string_equal(first("go to http://a.b/c.").c_str(), "http://a.b/c");
+    assert_string_equal(first("(http://a.b/c), then").c_str(), "http://a.b/c");
+    assert_string_equal(first("http://a.b/c?!").c_str(), "http://a.b/c");
+
+    // Balanced parentheses are kept, unbalanced ones end the link
+    assert_string_equal(first("http://w.org/Foo_(bar)").c_str(), "http://w.org/Foo_(bar)");
+    assert_string_equal(first("http://w.org/Foo_(bar").c_str(), "http://w.org/Foo_");
+    assert_string_equal(first("http://w.org/((x))").c_str(), "http://w.org/");
+}
+
+static void position(void**)
+{
+    std::string str = "http://a.b and https://c.d/e";
+    size_t start, end;
+
+    assert_true(UrlScan::find(str, 0, start, end));
+    assert_int_equal(start, 0);
+    assert_int_equal(end, 10);
+
+    assert_true(UrlScan::find(str, end, start, end));
+    assert_int_equal(start, 15);
+    assert_int_equal(end, str.size());
+    assert_false(UrlScan::find(str, end, start, end));
+
+    // A scheme that starts before pos is not reported
+    assert_true(first(str, 2).substr(0, 5) == "https");
+    assert_true(first(str, 17).empty());
+    assert_true(first("https://x", 1).empty());
+
+    // The word boundary before pos still applies
+    assert_true(first("ahttp://y", 1).empty());
+}
+
+int main()
+{
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(schemes),
+        cmocka_unit_test(body),
+        cmocka_unit_test(position),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
@@ -0,0 +1,199 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "mux/xterm/edgebase.cpp"
+#include "mux/xterm/graph.cpp"
+#include "mux/xterm/machine.cpp"
+
+#include <vector>
+
+static XTermStateMachine *s_state;
+static std::string s_called, s_text0, s_text1, s_error;
+static std::vector<int> s_nums;
+static std::string s_printed;
+
+// Handlers record what the parser handed them
+static void
+record(const char *name)
+{
+    s_called = name;
+    auto nums = s_state->nums(0);
+    s_nums.assign(nums.begin(), nums.end());
+    s_text0 = s_state->text(0).str();
+    s_text1 = s_state->text(1).str();
+}
+
+#define STUB(x) void XTermEmulator::x() { record(#x); }
+STUB(cmdApplicationKeypad) STUB(cmdCharacterAttributes) STUB(cmdCursorBackward)
+STUB(cmdCursorDown) STUB(cmdCursorForward) STUB(cmdCursorHorizontalAbsolute)
+STUB(cmdCursorNextLine) STUB(cmdCursorPosition) STUB(cmdCursorPreviousLine)
+STUB(cmdCursorUp) STUB(cmdCursorVerticalAbsolute) STUB(cmdDECDoubleHeightBottom)
+STUB(cmdDECDoubleHeightTop) STUB(cmdDECDoubleWidth) STUB(cmdDECPrivateModeRequest)
+STUB(cmdDECPrivateModeReset) STUB(cmdDECPrivateModeRestore) STUB(cmdDECPrivateModeSave)
+STUB(cmdDECPrivateModeSet) STUB(cmdDECScreenAlignmentTest) STUB(cmdDECSingleWidth)
+STUB(cmdDeleteCharacters) STUB(cmdDeleteLines) STUB(cmdDesignateCharset94)
+STUB(cmdDesignateCharset96) STUB(cmdDeviceStatusReport) STUB(cmdDisable8BitControls)
+STUB(cmdEnable8BitControls) STUB(cmdEraseCharacters) STUB(cmdEraseInDisplay)
+STUB(cmdEraseInLine) STUB(cmdIgnored) STUB(cmdInsertCharacters) STUB(cmdInsertLines)
+STUB(cmdInvokeCharset) STUB(cmdModeRequest) STUB(cmdNormalKeypad)
+STUB(cmdProtectionAttribute) STUB(cmdRepeatCharacter) STUB(cmdResetEmulator)
+STUB(cmdResetMode) STUB(cmdResetTitleModes) STUB(cmdRestoreCursor) STUB(cmdSaveCursor)
+STUB(cmdScrollDown) STUB(cmdScrollUp) STUB(cmdSelectiveEraseInDisplay)
+STUB(cmdSelectiveEraseInLine) STUB(cmdSendDeviceAttributes) STUB(cmdSendDeviceAttributes2)
+STUB(cmdSetCursorStyle) STUB(cmdSetLeftRightMargins) STUB(cmdSetMode)
+STUB(cmdSetTitleModes) STUB(cmdSetTopBottomMargins) STUB(cmdTabBackward)
+STUB(cmdTabClear) STUB(cmdTabForward) STUB(cmdWindowOps) STUB(dcsRequestStatusString)
+STUB(oscMain)
+
+void
+XTermEmulator::process()
+{
+    s_printed.push_back(s_state->allSequence().str().back());
+}
+
+void
+XTermEmulator::internalError(const char *msg)
+{
+    s_error = msg;
+}
+
+const char *
+Translator::get(const std::string &, const char *defval) const
+{
+    return defval;
+}
+
+/*
+ * Control sequence parser tests
+ */
+static void
+feed(const char *seq)
+{
+    // The handlers above never touch emulator state, so none is constructed
+    alignas(XTermEmulator) static char storage[sizeof(XTermEmulator)];
+    static XTermStateMachine state((XTermEmulator *)storage, nullptr);
+    s_state = &state;
+
+    s_called.clear();
+    s_error.clear();
+    s_printed.clear();
+    s_nums.clear();
+
+    for (const char *ptr = seq; *ptr; ++ptr)
+        state.process((unsigned char)*ptr);
+}
+
+static void csi(void**)
+{
+    feed("\x1b[1;22;333m");
+    assert_string_equal(s_called.c_str(), "cmdCharacterAttributes");
+    assert_true(s_nums == std::vector<int>({ 1, 22, 333 }));
+    assert_true(s_state->idle());
+
+    // 8-bit introducer and single numeric parameter
+    feed("\x9b" "5A");
+    assert_string_equal(s_called.c_str(), "cmdCursorUp");
+    assert_true(s_nums == std::vector<int>({ 5 }));
+
+    // Empty parameters parse as zero
+    feed("\x1b[;7H");
+    assert_string_equal(s_called.c_str(), "cmdCursorPosition");
+    assert_true(s_nums == std::vector<int>({ 0, 7 }));
+
+    feed("\x1b[?25h");
+    assert_string_equal(s_called.c_str(), "cmdDECPrivateModeSet");
+    assert_true(s_nums == std::vector<int>({ 25 }));
+
+    // Embedded controls are executed without ending the sequence
+    feed("\x1b[1\r;2m");
+    assert_string_equal(s_called.c_str(), "cmdCharacterAttributes");
+    assert_true(s_nums == std::vector<int>({ 1, 2 }));
+    assert_string_equal(s_printed.c_str(), "\r");
+
+    feed("ab");
+    assert_string_equal(s_printed.c_str(), "ab");
+    assert_true(s_called.empty());
+}
+
+static void params(void**)
+{
+    std::string seq = "\x1b[";
+    for (int i = 1; i < MAX_PARAMS; ++i)
+        seq += std::to_string(i) + ';';
+
+    // Exactly the maximum is accepted
+    feed((seq + "32m").c_str());
+    assert_string_equal(s_called.c_str(), "cmdCharacterAttributes");
+    assert_int_equal(s_nums.size(), MAX_PARAMS);
+    assert_int_equal(s_nums.back(), 32);
+    assert_true(s_error.empty());
+
+    // Extra parameters are ignored and the command still runs
+    feed((seq + "32;33;34m").c_str());
+    assert_string_equal(s_called.c_str(), "cmdCharacterAttributes");
+    assert_int_equal(s_nums.size(), MAX_PARAMS);
+    assert_int_equal(s_nums.back(), 32);
+    assert_true(s_error.empty());
+    assert_true(s_printed.empty());
+    assert_true(s_state->idle());
+
+    // The parser is ready for the next sequence
+    feed("\x1b[2J");
+    assert_string_equal(s_called.c_str(), "cmdEraseInDisplay");
+    assert_true(s_nums == std::vector<int>({ 2 }));
+    assert_true(s_error.empty());
+}
+
+static void osc(void**)
+{
+    feed("\x1b]2;hello\x07");
+    assert_string_equal(s_called.c_str(), "oscMain");
+    assert_true(s_nums == std::vector<int>({ 2 }));
+    assert_string_equal(s_text1.c_str(), "hello");
+
+    // String terminator instead of BEL
+    feed("\x1b]0;a b;c\x1b\\");
+    assert_string_equal(s_called.c_str(), "oscMain");
+    assert_true(s_nums == std::vector<int>({ 0 }));
+    assert_string_equal(s_text1.c_str(), "a b;c");
+
+    feed("\x9d" "104\x9c");
+    assert_string_equal(s_called.c_str(), "oscMain");
+    assert_true(s_nums == std::vector<int>({ 104 }));
+    assert_true(s_state->idle());
+}
+
+static void dcs(void**)
+{
+    feed("\x1bP$qm\x1b\\");
+    assert_string_equal(s_called.c_str(), "dcsRequestStatusString");
+    assert_string_equal(s_text0.c_str(), "m");
+
+    feed("\x90$q\"p\x9c");
+    assert_string_equal(s_called.c_str(), "dcsRequestStatusString");
+    assert_string_equal(s_text0.c_str(), "\"p");
+
+    feed("\x1bP1;1|17/ab\x1b\\");
+    assert_string_equal(s_called.c_str(), "cmdIgnored");
+    assert_true(s_state->idle());
+
+    // Unknown sequences are reported and abandoned
+    feed("\x1bPzz\x1b\\");
+    assert_true(s_called.empty());
+    assert_false(s_error.empty());
+}
+
+int main()
+{
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(csi),
+        cmocka_unit_test(params),
+        cmocka_unit_test(osc),
+        cmocka_unit_test(dcs),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}
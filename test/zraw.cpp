@@ -0,0 +1,113 @@
+// Copyright © 2018 TermySequence LLC
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "common.h"
+#include "cellunit.h"
+#include "lib/zraw.h"
+#include "lib/protocol.h"
+#include "lib/sequences.h"
+#include "lib/wire.h"
+
+#include <vector>
+
+// Collects written bytes and received commands
+struct Loopback final: Tsq::ProtocolCallback
+{
+    std::string wire;
+    std::vector<std::pair<uint32_t,std::string>> commands;
+
+    bool protocolCallback(uint32_t command, uint32_t length, const char *body)
+    {
+        commands.emplace_back(command, std::string(body, length));
+        return true;
+    }
+    void writeFd(const char *buf, size_t len)
+    {
+        wire.append(buf, len);
+    }
+};
+
+static void
+sendCommand(Tsq::ProtocolMachine &machine, uint32_t command, const std::string &str)
+{
+    Tsq::ProtocolMarshaler m(command);
+    m.addString(str);
+    machine.connSend(m.resultPtr(), m.length());
+}
+
+/*
+ * Compressed protocol tests
+ */
+static void roundTrip(void**)
+{
+    Loopback out, in;
+    Tsq::ZlibProtocol sender(&out), receiver(&in);
+    std::string big(200000, 'x');
+
+    sendCommand(sender, TSQ_DISCARD, "abc");
+    sendCommand(sender, TSQ_DISCARD, big);
+    sender.connFlush(nullptr, 0);
+    sendCommand(sender, TSQ_KEEPALIVE, "");
+    sender.connFlush(nullptr, 0);
+
+    assert_true(out.wire.size() < big.size() / 10);
+
+    // Feed in small pieces to cross frame boundaries
+    for (size_t i = 0; i < out.wire.size(); i += 7)
+        assert_true(receiver.connRead(out.wire.data() + i,
+                                      std::min<size_t>(7, out.wire.size() - i)));
+
+    assert_int_equal(in.commands.size(), 3);
+    assert_int_equal(in.commands[0].first, TSQ_DISCARD);
+    assert_string_equal(in.commands[0].second.c_str(), "abc");
+    assert_int_equal(in.commands[1].second.size(), big.size() + 1);
+    assert_int_equal(in.commands[2].first, TSQ_KEEPALIVE);
+
+    const auto *stats = receiver.stats();
+    assert_int_equal(stats->wireIn, out.wire.size());
+    assert_int_equal(stats->rawIn, sender.stats()->rawOut);
+}
+
+static void plainInterleave(void**)
+{
+    Loopback out, in;
+    Tsq::ZlibProtocol sender(&out), receiver(&in);
+
+    sendCommand(sender, TSQ_DISCARD, "abc");
+    sender.connFlush(nullptr, 0);
+    out.wire.append(TSQ_RAW_DISCONNECT, TSQ_RAW_DISCONNECT_LEN);
+
+    assert_true(receiver.connRead(out.wire.data(), out.wire.size()));
+    assert_int_equal(in.commands.size(), 2);
+    assert_int_equal(in.commands[1].first, TSQ_DISCONNECT);
+}
+
+static void encodeFinal(void**)
+{
+    Loopback out, in;
+    Tsq::ZlibProtocol sender(&out), receiver(&in);
+
+    sendCommand(sender, TSQ_DISCARD, "abc");
+    sender.connFlush(nullptr, 0);
+
+    Tsq::ProtocolMarshaler m(TSQ_DISCONNECT);
+    m.addNumber(TSQ_STATUS_SERVER_ERROR);
+    out.wire += sender.encode(m.resultPtr(), m.length());
+
+    assert_true(receiver.connRead(out.wire.data(), out.wire.size()));
+    assert_int_equal(in.commands.size(), 2);
+    assert_int_equal(in.commands[1].first, TSQ_DISCONNECT);
+    assert_int_equal(in.commands[1].second.size(), 4);
+}
+
+int main()
+{
+    const CMUnitTest tests[] = {
+        cmocka_unit_test(roundTrip),
+        cmocka_unit_test(plainInterleave),
+        cmocka_unit_test(encodeFinal),
+    };
+
+    return cmocka_run_group_tests(tests, nullptr, nullptr);
+}